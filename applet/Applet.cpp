@@ -32,6 +32,8 @@
 
 #include <cmath>
 
+#include <QtCore/QSet>
+
 #include <QtGui/QPainter>
 #include <QtGui/QGraphicsView>
 #include <QtGui/QDesktopWidget>
@@ -61,16 +63,36 @@ LauncherRule::LauncherRule(QString expressionI, RuleMatch matchI, bool requiredI
 {
 }
 
+Applet::IconKeys::IconKeys() : windows(0),
+    window(0),
+    launcher(NULL),
+    id(0)
+{
+}
+
 Applet::Applet(QObject *parent, const QVariantList &args) : Plasma::Applet(parent, args),
     m_groupManager(new TaskManager::GroupManager(this)),
+    m_manager(new Manager(this)),
+    m_themePixmaps(8388608),
+    m_progressPixmaps(8388608),
     m_size(500, 100),
     m_dropZone(new DropZone(this)),
     m_entriesAction(NULL),
-    m_animationTimeLine(new QTimeLine(100, this)),
     m_appletMaximumHeight(100),
     m_initialFactor(0),
     m_focusedItem(-1),
-    m_initialized(false)
+    m_animationTimer(0),
+    m_geometryTimer(0),
+    m_jobsTimer(0),
+    m_layoutTransactions(0),
+    m_hoverAnimationStart(-1),
+    m_cacheRevision(0),
+    m_frameCacheCost(0),
+    m_frameCacheLimit(16777216),
+    m_suppressedJobs(0),
+    m_coalescedJobs(0),
+    m_initialized(false),
+    m_tasksDeferred(false)
 {
     setObjectName("FancyTasksApplet");
 
@@ -81,8 +103,7 @@ Applet::Applet(QObject *parent, const QVariantList &args) : Plasma::Applet(paren
     setAcceptDrops(true);
     setFlag(QGraphicsItem::ItemIsFocusable);
 
-    m_animationTimeLine->setFrameRange(0, 100);
-    m_animationTimeLine->setUpdateInterval(40);
+    m_animationClock.start();
 
     m_theme = new Plasma::FrameSvg(this);
     m_theme->setImagePath("widgets/fancytasks");
@@ -90,21 +111,32 @@ Applet::Applet(QObject *parent, const QVariantList &args) : Plasma::Applet(paren
 
     m_background = m_theme;
 
-    m_layout = new QGraphicsLinearLayout;
+    m_layout = new DockLayout;
     m_layout->setContentsMargins(2, 2, 2, 2);
-    m_layout->setSpacing(0);
 
     setLayout(m_layout);
 
     resize(100, 100);
 
+    connect(this, SIGNAL(geometryChanged()), this, SLOT(appletGeometryChanged()));
+    connect(m_manager, SIGNAL(windowsChanged(QList<WId>)), this, SLOT(updateApplications(QList<WId>)));
     connect(m_dropZone, SIGNAL(visibilityChanged(bool)), this, SLOT(updateSize()));
     connect(Plasma::Theme::defaultTheme(), SIGNAL(themeChanged()), this, SLOT(updateTheme()));
 }
 
 Applet::~Applet()
 {
-    QMap<Launcher*, QPointer<Icon> >::iterator launcherIconsIterator;
+    QHash<int, QPointer<Icon> >::iterator iconsIterator;
+
+    for (iconsIterator = m_icons.begin(); iconsIterator != m_icons.end(); ++iconsIterator)
+    {
+        if (iconsIterator.value())
+        {
+            iconsIterator.value()->disconnect(this);
+        }
+    }
+
+    QHash<Launcher*, QPointer<Icon> >::iterator launcherIconsIterator;
 
     for (launcherIconsIterator = m_launcherIcons.begin(); launcherIconsIterator != m_launcherIcons.end(); ++launcherIconsIterator)
     {
@@ -133,8 +165,6 @@ void Applet::init()
     updateTheme();
 
     QTimer::singleShot(100, this, SLOT(configChanged()));
-
-    connect(m_animationTimeLine, SIGNAL(frameChanged(int)), this, SLOT(moveAnimation(int)));
 }
 
 void Applet::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
@@ -320,6 +350,97 @@ void Applet::focusInEvent(QFocusEvent *event)
     focusNextPrevChild(true);
 }
 
+void Applet::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_geometryTimer)
+    {
+        killTimer(m_geometryTimer);
+
+        m_geometryTimer = 0;
+
+        QGraphicsView *view = parentView();
+
+        for (int i = 0; i < m_geometryIcons.count(); ++i)
+        {
+            if (m_geometryIcons.at(i))
+            {
+                m_geometryIcons.at(i)->updateIconGeometry(view);
+            }
+        }
+
+        m_geometryIcons.clear();
+
+        return;
+    }
+
+    if (event->timerId() == m_jobsTimer)
+    {
+        killTimer(m_jobsTimer);
+
+        m_jobsTimer = 0;
+
+        showJobs(animationTime());
+
+        return;
+    }
+
+    if (event->timerId() != m_animationTimer)
+    {
+        Plasma::Applet::timerEvent(event);
+
+        return;
+    }
+
+    const qint64 time = animationTime();
+
+    if (m_hoveredItem)
+    {
+        m_activeItem = m_visibleIndexes.value(m_hoveredItem, -1);
+        m_across = m_hoveredAcross;
+
+        m_hoveredItem = NULL;
+
+        moveAnimation(100);
+    }
+
+    for (int i = 0; i < m_animatedIcons.count(); ++i)
+    {
+        if (!m_animatedIcons.at(i) || !m_animatedIcons.at(i)->advanceAnimation(time))
+        {
+            m_animatedIcons.removeAt(i);
+
+            --i;
+        }
+    }
+
+    if (m_hoverAnimationStart >= 0)
+    {
+        const int progress = qMin(qint64(100), (time - m_hoverAnimationStart));
+
+        moveAnimation(progress);
+
+        if (progress >= 100)
+        {
+            m_hoverAnimationStart = -1;
+        }
+    }
+
+    if (m_animatedIcons.isEmpty() && m_hoverAnimationStart < 0)
+    {
+        killTimer(m_animationTimer);
+
+        m_animationTimer = 0;
+    }
+}
+
+void Applet::startAnimationClock()
+{
+    if (!m_animationTimer)
+    {
+        m_animationTimer = startTimer(16);
+    }
+}
+
 void Applet::configChanged()
 {
     KConfigGroup configuration = config();
@@ -455,6 +576,8 @@ void Applet::configChanged()
     m_initialFactor = ((m_moveAnimation == ZoomAnimation)?configuration.readEntry("initialZoomLevel", 0.7):((m_moveAnimation == JumpAnimation)?0.7:0));
     m_paintReflections = configuration.readEntry("paintReflections", true);
 
+    ++m_cacheRevision;
+
     m_groupManager->setGroupingStrategy(groupingStrategy);
     m_groupManager->setSortingStrategy(sortingStrategy);
     m_groupManager->setShowOnlyCurrentDesktop(configuration.readEntry("showOnlyCurrentDesktop", false));
@@ -518,24 +641,7 @@ void Applet::insertItem(int index, QGraphicsLayoutItem *item)
     updateSize();
 }
 
-void Applet::checkStartup()
-{
-    if (m_startupsQueue.isEmpty())
-    {
-        return;
-    }
-
-    QPointer<Task> task = m_startupsQueue.dequeue();
-
-    if (task)
-    {
-        addTask(task->abstractItem(), true);
-
-        task->deleteLater();
-    }
-}
-
-void Applet::addTask(AbstractGroupableItem *abstractItem, bool force)
+void Applet::addTask(AbstractGroupableItem *abstractItem)
 {
     if (!abstractItem || (!m_arrangement.contains("tasks") && !m_showOnlyTasksWithLaunchers) || m_groupManager->rootGroup()->members().indexOf(abstractItem) < 0)
     {
@@ -554,37 +660,27 @@ void Applet::addTask(AbstractGroupableItem *abstractItem, bool force)
         task = new Task(abstractItem, this);
     }
 
-    if (task->taskType() == StartupType && !force)
-    {
-        m_startupsQueue.enqueue(task);
-
-        QTimer::singleShot(250, this, SLOT(checkStartup()));
-
-        return;
-    }
-
     Icon *icon = NULL;
 
     if (m_groupManager->sortingStrategy() == TaskManager::GroupManager::NoSorting || m_groupManager->sortingStrategy() == TaskManager::GroupManager::ManualSorting || m_showOnlyTasksWithLaunchers)
     {
         Launcher *launcher = launcherForTask(task);
 
-        if (m_groupManager->groupingStrategy() == TaskManager::GroupManager::ProgramGrouping)
+        if (m_groupManager->groupingStrategy() == TaskManager::GroupManager::ProgramGrouping && launcher)
         {
-            QMap<AbstractGroupableItem*, QPointer<Icon> >::iterator launcherTaskIconsIterator;
+            icon = m_launcherIcons.value(launcher);
 
-            for (launcherTaskIconsIterator = m_launcherTaskIcons.begin(); launcherTaskIconsIterator != m_launcherTaskIcons.end(); ++launcherTaskIconsIterator)
+            if (icon && icon->task() && icon->task()->taskType() == GroupType && icon->task()->members().indexOf(abstractItem) && !m_iconKeys.value(icon).launcherTasks.isEmpty())
             {
-                if (launcherTaskIconsIterator.value()->launcher() == launcher && launcherTaskIconsIterator.value()->task() && launcherTaskIconsIterator.value()->task()->taskType() == GroupType && launcherTaskIconsIterator.value()->task()->members().indexOf(abstractItem))
-                {
-                    launcherTaskIconsIterator.value()->setTask(task);
+                icon->setTask(task);
 
-                    m_launcherTaskIcons[abstractItem] = launcherTaskIconsIterator.value();
-                    m_launcherTaskIcons.remove(launcherTaskIconsIterator.key());
+                removeLauncherTaskIcon(m_iconKeys.value(icon).launcherTasks.first());
+                setLauncherTaskIcon(abstractItem, icon);
 
-                    return;
-                }
+                return;
             }
+
+            icon = NULL;
         }
 
         if (launcher && m_launcherIcons.contains(launcher))
@@ -595,10 +691,10 @@ void Applet::addTask(AbstractGroupableItem *abstractItem, bool force)
             {
                 if (task->taskType() == GroupType && icon->task())
                 {
-                    m_launcherTaskIcons.remove(icon->task()->abstractItem());
+                    removeLauncherTaskIcon(icon->task()->abstractItem());
                 }
 
-                m_launcherTaskIcons[abstractItem] = icon;
+                setLauncherTaskIcon(abstractItem, icon);
 
                 icon->setTask(task);
 
@@ -616,27 +712,24 @@ void Applet::addTask(AbstractGroupableItem *abstractItem, bool force)
         }
     }
 
-    if ((task->taskType() == TaskType || task->taskType() == GroupType) && (!task->title().isEmpty() || !task->command().isEmpty()))
+    if (task->taskType() == TaskType && m_startupMatcher.count() > 0)
     {
-        const QString title = task->title();
-        const QString command = task->command();
-        QMap<AbstractGroupableItem*, QPointer<Icon> >::iterator taskIconsIterator;
-
-        for (taskIconsIterator = m_taskIcons.begin(); taskIconsIterator != m_taskIcons.end(); ++taskIconsIterator)
+        if (task->windows().isEmpty())
         {
-            if (!taskIconsIterator.value())
-            {
-                m_taskIcons.erase(taskIconsIterator);
+            icon = m_startupMatcher.match(QByteArray(), (QStringList() << task->command()));
+        }
+        else
+        {
+            const WindowProperties properties = m_manager->properties(task->windows().first());
 
-                continue;
-            }
+            icon = m_startupMatcher.match(properties.startupId, (QStringList() << task->command() << properties.windowName << properties.windowClass));
+        }
 
-            if (taskIconsIterator.value()->task() && taskIconsIterator.value()->task()->taskType() == StartupType && ((!title.isEmpty() && title.contains(taskIconsIterator.value()->task()->title(), Qt::CaseInsensitive)) || (command.isEmpty() && command.contains(taskIconsIterator.value()->task()->command(), Qt::CaseInsensitive))))
-            {
-                taskIconsIterator.value()->setTask(task);
+        if (icon)
+        {
+            m_startupMatcher.removeStartup(icon);
 
-                break;
-            }
+            icon->setTask(task);
         }
     }
 
@@ -652,50 +745,65 @@ void Applet::addTask(AbstractGroupableItem *abstractItem, bool force)
         }
 
         insertItem(index, icon);
+
+        if (task->taskType() == StartupType && abstractItem->itemType() == TaskManager::TaskItemType)
+        {
+            TaskManager::TaskItem *taskItem = static_cast<TaskManager::TaskItem*>(abstractItem);
+
+            m_startupMatcher.addStartup(icon, (taskItem->startup()?taskItem->startup()->id().id():QByteArray()), task->command());
+
+            connect(taskItem, SIGNAL(gotTaskPointer()), this, SLOT(resolveStartup()));
+        }
     }
 
-    m_taskIcons[abstractItem] = icon;
+    setTaskIcon(abstractItem, icon);
 }
 
 void Applet::removeTask(AbstractGroupableItem *abstractItem)
 {
     if (m_launcherTaskIcons.contains(abstractItem))
     {
-        if (m_launcherTaskIcons[abstractItem])
+        Icon *launcherIcon = m_launcherTaskIcons.value(abstractItem);
+
+        if (launcherIcon)
         {
-            if (m_launcherTaskIcons[abstractItem]->task() && m_launcherTaskIcons[abstractItem]->task()->abstractItem() && abstractItem != m_launcherTaskIcons[abstractItem]->task()->abstractItem())
+            if (launcherIcon->task() && launcherIcon->task()->abstractItem() && abstractItem != launcherIcon->task()->abstractItem())
             {
-                if (m_groupManager->groupingStrategy() == TaskManager::GroupManager::NoGrouping)
+                if (m_groupManager->groupingStrategy() == TaskManager::GroupManager::NoGrouping && launcherIcon->launcher())
                 {
-                    QMap<AbstractGroupableItem*, QPointer<Icon> >::iterator taskIconsIterator;
+                    const QList<QObject*> items = launcherIcon->launcher()->items();
 
-                    for (taskIconsIterator = m_taskIcons.begin(); taskIconsIterator != m_taskIcons.end(); ++taskIconsIterator)
+                    for (int i = 0; i < items.count(); ++i)
                     {
-                        if (taskIconsIterator.value()->launcher() && taskIconsIterator.value()->launcher() == m_launcherTaskIcons[abstractItem]->launcher())
+                        Icon *icon = qobject_cast<Icon*>(items.at(i));
+
+                        if (!icon || icon == launcherIcon || icon->launcher() != launcherIcon->launcher() || !icon->task() || !icon->task()->abstractItem() || m_iconKeys.value(icon).tasks.isEmpty())
                         {
-                            m_launcherTaskIcons[abstractItem]->setTask(taskIconsIterator.value()->task());
-                            m_launcherTaskIcons[taskIconsIterator.value()->task()->abstractItem()] = m_launcherTaskIcons[abstractItem];
+                            continue;
+                        }
 
-                            m_taskIcons[taskIconsIterator.key()]->deleteLater();
+                        launcherIcon->setTask(icon->task());
 
-                            m_taskIcons.remove(taskIconsIterator.key());
+                        setLauncherTaskIcon(icon->task()->abstractItem(), launcherIcon);
+                        removeTaskIcon(m_iconKeys.value(icon).tasks.first());
 
-                            break;
-                        }
+                        icon->deleteLater();
+
+                        break;
                     }
                 }
                 else
                 {
-                    m_launcherTaskIcons[m_launcherTaskIcons[abstractItem]->task()->abstractItem()] = m_launcherTaskIcons[abstractItem];
+                    setLauncherTaskIcon(launcherIcon->task()->abstractItem(), launcherIcon);
                 }
             }
             else
             {
-                m_launcherTaskIcons[abstractItem]->setTask(NULL);
+                launcherIcon->setTask(NULL);
             }
         }
 
-        m_launcherTaskIcons.remove(abstractItem);
+        removeLauncherTaskIcon(abstractItem);
 
         return;
     }
@@ -707,21 +815,35 @@ void Applet::removeTask(AbstractGroupableItem *abstractItem)
 
     QPointer<Icon> icon = m_taskIcons[abstractItem];
 
-    if (icon && icon->itemType() == StartupType)
+    removeTaskIcon(abstractItem);
+
+    if (!icon || (icon->task() && icon->task()->abstractItem() != abstractItem))
     {
         return;
     }
 
-    m_taskIcons.remove(abstractItem);
+    m_layout->removeItem(icon);
 
-    if (!icon)
+    delete icon;
+}
+
+void Applet::resolveStartup()
+{
+    TaskManager::TaskItem *taskItem = qobject_cast<TaskManager::TaskItem*>(sender());
+
+    if (!taskItem)
     {
         return;
     }
 
-    m_layout->removeItem(icon);
+    disconnect(taskItem, SIGNAL(gotTaskPointer()), this, SLOT(resolveStartup()));
 
-    delete icon;
+    Icon *icon = m_taskIcons.value(taskItem);
+
+    if (icon)
+    {
+        m_startupMatcher.removeStartup(icon);
+    }
 }
 
 void Applet::changeTaskPosition(AbstractGroupableItem *abstractItem)
@@ -731,7 +853,7 @@ void Applet::changeTaskPosition(AbstractGroupableItem *abstractItem)
         return;
     }
 
-    Icon *icon = m_taskIcons[abstractItem];
+    Icon *icon = m_taskIcons.value(abstractItem);
 
     if (!icon || !icon->task() || !icon->task()->abstractItem())
     {
@@ -794,6 +916,7 @@ void Applet::addLauncher(Launcher *launcher, int index)
     }
 
     m_launcherIcons[launcher] = icon;
+    m_iconKeys[icon].launcher = launcher;
 
     if (!m_arrangement.contains(url))
     {
@@ -829,11 +952,11 @@ void Applet::removeLauncher(Launcher *launcher)
     if (launcher)
     {
         m_launchers.removeAll(launcher);
-    }
 
-    Icon *icon = m_launcherIcons[launcher];
+        updateRules();
+    }
 
-    m_launcherIcons.remove(launcher);
+    Icon *icon = m_launcherIcons.take(launcher);
 
     if (!icon)
     {
@@ -927,10 +1050,13 @@ void Applet::addJob(const QString &source)
 
     Job *job = new Job(source, this);
 
-    m_jobsQueue.enqueue(job);
+    m_jobsQueue.enqueue(qMakePair((animationTime() + 1500), QPointer<Job>(job)));
     m_jobs[source] = job;
 
-    QTimer::singleShot(1500, this, SLOT(showJob()));
+    if (m_jobsQueue.count() == 1)
+    {
+        scheduleJobs();
+    }
 }
 
 void Applet::removeJob(const QString &source, bool force)
@@ -939,7 +1065,8 @@ void Applet::removeJob(const QString &source, bool force)
 
     if (!job)
     {
-        m_jobIcons.remove(m_jobs[source]);
+        removeJobIcon(m_jobs[source]);
+
         m_jobs.remove(source);
 
         return;
@@ -954,7 +1081,12 @@ void Applet::removeJob(const QString &source, bool force)
     {
         if (m_jobCloseMode == DelayedClose && !force)
         {
-            QTimer::singleShot(5000, job, SLOT(close()));
+            m_closingJobs.enqueue(qMakePair((animationTime() + 5000), job));
+
+            if (m_closingJobs.count() == 1)
+            {
+                scheduleJobs();
+            }
         }
         else if (job->state() != ErrorState)
         {
@@ -967,7 +1099,8 @@ void Applet::removeJob(const QString &source, bool force)
         return;
     }
 
-    m_jobIcons.remove(m_jobs[source]);
+    removeJobIcon(job);
+
     m_jobs.remove(source);
 
     if (!job)
@@ -978,87 +1111,112 @@ void Applet::removeJob(const QString &source, bool force)
     job->destroy();
 }
 
-void Applet::showJob()
+void Applet::showJobs(qint64 time)
 {
-    QPointer<Job> job = m_jobsQueue.dequeue();
-
-    if (!job)
-    {
-        return;
-    }
-
-    if (job->state() == FinishedState)
+    while (!m_closingJobs.isEmpty() && m_closingJobs.head().first <= time)
     {
-        job->close();
+        QPointer<Job> job = m_closingJobs.dequeue().second;
 
-        return;
+        if (job)
+        {
+            job->close();
+        }
     }
 
-    QString className;
-
-    if (m_jobCloseMode != ManualClose)
+    if (!m_jobsQueue.isEmpty() && m_jobsQueue.head().first <= time)
     {
-        job->setCloseOnFinish(true);
-    }
+        int shown = 0;
 
-    if (m_connectJobsWithTasks)
-    {
-        QMap<TaskManager::AbstractGroupableItem*, QPointer<Icon> >::iterator tasksIterator;
+        beginLayoutTransaction();
 
-        for (tasksIterator = m_taskIcons.begin(); tasksIterator != m_taskIcons.end(); ++tasksIterator)
+        while (!m_jobsQueue.isEmpty() && m_jobsQueue.head().first <= (time + 250))
         {
-            if (!tasksIterator.value())
-            {
-                continue;
-            }
+            QPointer<Job> job = m_jobsQueue.dequeue().second;
 
-            if (tasksIterator.key()->itemType() == TaskManager::GroupItemType && m_groupManager->groupingStrategy() != TaskManager::GroupManager::ManualGrouping)
+            if (!job || job->state() == FinishedState)
             {
-                TaskManager::TaskGroup *group = static_cast<TaskManager::TaskGroup*>(tasksIterator.key());
+                ++m_suppressedJobs;
 
-                if (!group || !group->members().count())
+                if (job)
                 {
-                    continue;
+                    job->close();
                 }
 
-                if (group->name().isEmpty())
-                {
-                    className = KWindowSystem::windowInfo(static_cast<TaskManager::TaskItem*>(group->members().at(0))->task()->window(), 0, NET::WM2WindowClass).windowClassName();
-                }
+                continue;
             }
-            else if (tasksIterator.key()->itemType() != TaskManager::GroupItemType)
+
+            if (shown > 0)
             {
-                className = KWindowSystem::windowInfo(static_cast<TaskManager::TaskItem*>(tasksIterator.key())->task()->window(), 0, NET::WM2WindowClass).windowClassName();
+                ++m_coalescedJobs;
             }
 
-            if (job->application().contains(className, Qt::CaseInsensitive))
-            {
-                tasksIterator.value()->addJob(job);
+            ++shown;
 
-                return;
-            }
+            showJob(job);
         }
+
+        commitLayoutTransaction();
     }
 
-    if (m_groupJobs)
+    scheduleJobs();
+}
+
+void Applet::scheduleJobs()
+{
+    if (m_jobsTimer)
     {
-        QMap<Job*, QPointer<Icon> >::iterator jobsIterator;
+        killTimer(m_jobsTimer);
 
-        for (jobsIterator = m_jobIcons.begin(); jobsIterator != m_jobIcons.end(); ++jobsIterator)
-        {
-            if (!jobsIterator.value())
-            {
-                continue;
-            }
+        m_jobsTimer = 0;
+    }
 
-            if (job->application() == jobsIterator.key()->application())
-            {
-                jobsIterator.value()->addJob(job);
+    qint64 deadline = -1;
 
-                return;
-            }
+    if (!m_jobsQueue.isEmpty())
+    {
+        deadline = m_jobsQueue.head().first;
+    }
+
+    if (!m_closingJobs.isEmpty() && (deadline < 0 || m_closingJobs.head().first < deadline))
+    {
+        deadline = m_closingJobs.head().first;
+    }
+
+    if (deadline >= 0)
+    {
+        m_jobsTimer = startTimer(qMax(0, int(deadline - animationTime())));
+    }
+}
+
+void Applet::showJob(Job *job)
+{
+    if (m_jobCloseMode != ManualClose)
+    {
+        job->setCloseOnFinish(true);
+    }
+
+    if (m_connectJobsWithTasks)
+    {
+        Icon *icon = applicationIcon(job->application());
+
+        if (icon)
+        {
+            icon->addJob(job);
+
+            return;
         }
+    }
+
+    if (m_groupJobs)
+    {
+        Icon *icon = m_applicationJobIcons.value(job->application());
+
+        if (icon)
+        {
+            icon->addJob(job);
 
+            return;
+        }
     }
 
     Icon *icon = createIcon(NULL, NULL, job);
@@ -1072,44 +1230,93 @@ void Applet::showJob()
 
     insertItem(index, icon);
 
-    m_jobIcons[job] = icon;
+    setJobIcon(job, icon);
+}
+
+void Applet::removePendingSize(QObject *object)
+{
+    QHash<QGraphicsWidget*, QSizeF>::iterator iterator = m_pendingSizes.begin();
+
+    while (iterator != m_pendingSizes.end())
+    {
+        if (static_cast<QObject*>(iterator.key()) == object)
+        {
+            iterator = m_pendingSizes.erase(iterator);
+        }
+        else
+        {
+            ++iterator;
+        }
+    }
 }
 
-void Applet::cleanup()
+void Applet::removeIcon(QObject *object)
 {
-    QMap<AbstractGroupableItem*, QPointer<Icon> >::iterator taskIconsIterator;
-    QMap<Launcher*, QPointer<Icon> >::iterator launcherIconsIterator;
-    QMap<Job*, QPointer<Icon> >::iterator jobIconsIterator;
+    const IconKeys keys = m_iconKeys.take(object);
+
+    m_frameCacheCost -= m_frameCosts.take(object);
 
-    for (taskIconsIterator = m_taskIcons.begin(); taskIconsIterator != m_taskIcons.end(); ++taskIconsIterator)
+    m_startupMatcher.removeStartup(object);
+
+    for (int i = 0; i < keys.tasks.count(); ++i)
     {
-        if (!taskIconsIterator.value())
+        if (!m_taskIcons.value(keys.tasks.at(i)))
         {
-            m_taskIcons.erase(taskIconsIterator);
+            m_taskIcons.remove(keys.tasks.at(i));
         }
     }
 
-    for (taskIconsIterator = m_launcherTaskIcons.begin(); taskIconsIterator != m_launcherTaskIcons.end(); ++taskIconsIterator)
+    for (int i = 0; i < keys.launcherTasks.count(); ++i)
     {
-        if (!taskIconsIterator.value())
+        if (!m_launcherTaskIcons.value(keys.launcherTasks.at(i)))
         {
-            m_launcherTaskIcons.erase(taskIconsIterator);
+            m_launcherTaskIcons.remove(keys.launcherTasks.at(i));
         }
     }
 
-    for (launcherIconsIterator = m_launcherIcons.begin(); launcherIconsIterator != m_launcherIcons.end(); ++launcherIconsIterator)
+    for (int i = 0; i < keys.jobs.count(); ++i)
     {
-        if (!launcherIconsIterator.value())
+        if (!m_jobIcons.value(keys.jobs.at(i)))
         {
-            m_launcherIcons.erase(launcherIconsIterator);
+            m_jobIcons.remove(keys.jobs.at(i));
         }
     }
 
-    for (jobIconsIterator = m_jobIcons.begin(); jobIconsIterator != m_jobIcons.end(); ++jobIconsIterator)
+    if (keys.launcher && !m_launcherIcons.value(keys.launcher))
+    {
+        m_launcherIcons.remove(keys.launcher);
+    }
+
+    if (!m_icons.value(keys.id))
+    {
+        m_icons.remove(keys.id);
+    }
+
+    if (keys.windows)
     {
-        if (!jobIconsIterator.value())
+        m_windowIcons.remove(keys.windows, QPointer<Icon>());
+    }
+
+    if (!keys.application.isEmpty())
+    {
+        m_applicationIcons.remove(keys.application, QPointer<Icon>());
+    }
+
+    if (keys.window && !m_applicationWindows.value(keys.window))
+    {
+        m_applicationWindows.remove(keys.window);
+    }
+}
+
+void Applet::updateApplications(const QList<WId> &windows)
+{
+    for (int i = 0; i < windows.count(); ++i)
+    {
+        Icon *icon = m_applicationWindows.value(windows.at(i));
+
+        if (icon)
         {
-            m_jobIcons.erase(jobIconsIterator);
+            indexApplication(icon);
         }
     }
 }
@@ -1122,10 +1329,12 @@ void Applet::reload()
     disconnect(dataEngine("applicationjobs"), SIGNAL(sourceAdded(const QString)), this, SLOT(addJob(const QString)));
     disconnect(dataEngine("applicationjobs"), SIGNAL(sourceRemoved(const QString)), this, SLOT(removeJob(const QString)));
 
+    m_tasksDeferred = false;
+
     m_visibleItems.clear();
+    m_visibleIndexes.clear();
+    m_pendingLaunchers.clear();
 
-    qDeleteAll(m_jobsQueue);
-    qDeleteAll(m_startupsQueue);
     qDeleteAll(m_launchers);
     qDeleteAll(m_tasks);
     qDeleteAll(m_jobs);
@@ -1133,26 +1342,21 @@ void Applet::reload()
 
     for (int i = 0; i < m_layout->count(); ++i)
     {
-        QObject *object = dynamic_cast<QObject*>(m_layout->itemAt(i));
-
-        if (!object)
-        {
-            continue;
-        }
-
-        if (object->objectName() == "FancyTasksIcon" || object->objectName() == "FancyTasksSeparator")
+        if (m_layout->kind(i) == DockLayout::IconItem || m_layout->kind(i) == DockLayout::SeparatorItem)
         {
-            object->deleteLater();
+            m_layout->widgetAt(i)->deleteLater();
         }
     }
 
     m_jobsQueue.clear();
-    m_startupsQueue.clear();
+    m_closingJobs.clear();
     m_launchers.clear();
     m_tasks.clear();
     m_jobs.clear();
     m_launchers.clear();
 
+    updateRules();
+
     int index = 1;
 
     for (int i = 0; i < m_arrangement.count(); ++i)
@@ -1174,22 +1378,19 @@ void Applet::reload()
         }
         else if (m_arrangement.at(i) != "tasks" && m_arrangement.at(i) != "jobs")
         {
-            addLauncher(launcherForUrl(m_arrangement.at(i)), index);
+            addLauncher(launcherForUrl(m_arrangement.at(i), true), index);
 
             ++index;
         }
     }
 
-    if (m_arrangement.contains("tasks") || m_showOnlyTasksWithLaunchers)
+    if (m_pendingLaunchers.isEmpty())
     {
-        connect(m_groupManager->rootGroup(), SIGNAL(itemAdded(AbstractGroupableItem*)), this, SLOT(addTask(AbstractGroupableItem*)));
-        connect(m_groupManager->rootGroup(), SIGNAL(itemRemoved(AbstractGroupableItem*)), this, SLOT(removeTask(AbstractGroupableItem*)));
-        connect(m_groupManager->rootGroup(), SIGNAL(itemPositionChanged(AbstractGroupableItem*)), this, SLOT(changeTaskPosition(AbstractGroupableItem*)));
-
-        foreach (TaskManager::AbstractGroupableItem* abstractItem, m_groupManager->rootGroup()->members())
-        {
-            addTask(abstractItem);
-        }
+        addTasks();
+    }
+    else
+    {
+        m_tasksDeferred = true;
     }
 
     if (m_arrangement.contains("jobs"))
@@ -1208,65 +1409,156 @@ void Applet::reload()
     updateSize();
 }
 
-void Applet::itemHoverMoved(QGraphicsWidget *item, qreal across)
+void Applet::addTasks()
 {
-    m_activeItem = m_visibleItems.indexOf(item);
+    if (!m_arrangement.contains("tasks") && !m_showOnlyTasksWithLaunchers)
+    {
+        return;
+    }
 
-    m_across = across;
+    connect(m_groupManager->rootGroup(), SIGNAL(itemAdded(AbstractGroupableItem*)), this, SLOT(addTask(AbstractGroupableItem*)));
+    connect(m_groupManager->rootGroup(), SIGNAL(itemRemoved(AbstractGroupableItem*)), this, SLOT(removeTask(AbstractGroupableItem*)));
+    connect(m_groupManager->rootGroup(), SIGNAL(itemPositionChanged(AbstractGroupableItem*)), this, SLOT(changeTaskPosition(AbstractGroupableItem*)));
 
-    moveAnimation(100);
-}
+    QList<WId> windows;
 
-void Applet::hoverLeft()
-{
-    m_animationTimeLine->stop();
+    foreach (TaskManager::AbstractGroupableItem* abstractItem, m_groupManager->rootGroup()->members())
+    {
+        windows.append(abstractItem->winIds().toList());
+    }
+
+    m_manager->prefetch(windows);
+
+    foreach (TaskManager::AbstractGroupableItem* abstractItem, m_groupManager->rootGroup()->members())
+    {
+        addTask(abstractItem);
+    }
+}
+
+void Applet::launcherResolved()
+{
+    m_pendingLaunchers.removeAll(QPointer<Launcher>());
+    m_pendingLaunchers.removeAll(qobject_cast<Launcher*>(sender()));
+
+    if (m_tasksDeferred && m_pendingLaunchers.isEmpty())
+    {
+        m_tasksDeferred = false;
+
+        addTasks();
+
+        updateSize();
+    }
+}
+
+void Applet::itemHoverMoved(QGraphicsWidget *item, qreal across)
+{
+    m_hoveredItem = item;
+    m_hoveredAcross = across;
+
+    startAnimationClock();
+}
+
+void Applet::hoverLeft()
+{
+    m_hoveredItem = NULL;
 
     m_activeItem = -1;
 
-    m_animationTimeLine->start();
+    m_hoverAnimationStart = animationTime();
+
+    startAnimationClock();
 }
 
 void Applet::moveAnimation(int progress)
 {
-    qreal factor;
-    qreal animationProgres = ((qreal) progress / 100);
+    const qreal animationProgress = ((qreal) progress / 100);
+    QSet<Icon*> rangeIcons;
 
-    for (int i = 0; i < m_visibleItems.count(); ++i)
+    beginLayoutTransaction();
+
+    if (m_activeItem >= 0 && m_activeItem < m_visibleItems.count())
     {
-        if (m_visibleItems.at(i)->objectName() != "FancyTasksIcon")
+        const int range = (m_parabolicMoveAnimation?3:0);
+        const int last = qMin((m_visibleItems.count() - 1), (m_activeItem + range));
+
+        for (int i = qMax(0, (m_activeItem - range)); i <= last; ++i)
         {
-            continue;
-        }
+            Icon *icon = qobject_cast<Icon*>(m_visibleItems.at(i));
 
-        Icon *icon = static_cast<Icon*>(m_visibleItems.at(i));
+            if (!icon || !icon->isVisible())
+            {
+                continue;
+            }
 
-        if (!icon || !icon->isVisible())
-        {
-            continue;
-        }
+            rangeIcons.insert(icon);
 
-        if (i == m_activeItem)
-        {
-            factor = 1;
-        }
-        else if (!m_parabolicMoveAnimation || m_activeItem < 0 || i < (m_activeItem - 3) || i > (m_activeItem + 3))
-        {
-            factor = m_initialFactor;
+            zoomIcon(icon, ((i == m_activeItem)?1:(m_initialFactor + ((1 - m_initialFactor) * zoomWeight((i - m_activeItem), m_across)))), animationProgress);
         }
-        else if (i < m_activeItem)
+    }
+
+    for (int i = 0; i < m_zoomedIcons.count(); ++i)
+    {
+        Icon *icon = m_zoomedIcons.at(i);
+
+        if (icon && icon->isVisible() && !rangeIcons.contains(icon))
         {
-            factor = (m_initialFactor + ((1 - m_initialFactor) * (cos(((i - m_activeItem - m_across + 1) / 3) * PI) + 1)) / 2);
+            zoomIcon(icon, icon->restingFactor(), animationProgress);
         }
-        else
+    }
+
+    for (int i = 0; i < m_zoomedIcons.count(); ++i)
+    {
+        if (!m_zoomedIcons.at(i) || !m_zoomedIcons.at(i)->isVisible() || m_zoomedIcons.at(i)->factor() == m_zoomedIcons.at(i)->restingFactor())
         {
-            factor = (m_initialFactor + ((1 - m_initialFactor) * (cos(((i - m_activeItem - m_across) / 3) * PI) + 1)) / 2);
+            m_zoomedIcons.removeAt(i);
+
+            --i;
         }
+    }
 
-        if (icon->factor() != factor)
+    commitLayoutTransaction();
+}
+
+void Applet::zoomIcon(Icon *icon, qreal factor, qreal progress)
+{
+    if (icon->factor() != factor)
+    {
+        icon->setFactor((progress >= 1)?factor:(icon->factor() + ((factor - icon->factor()) * progress)));
+    }
+
+    if (icon->factor() != icon->restingFactor() && !m_zoomedIcons.contains(icon))
+    {
+        m_zoomedIcons.append(icon);
+    }
+}
+
+qreal Applet::zoomWeight(int distance, qreal across)
+{
+    static qreal weights[7][65];
+    static bool initialized = false;
+
+    if (!initialized)
+    {
+        for (int i = 0; i < 7; ++i)
         {
-            icon->setFactor(icon->factor() + ((factor - icon->factor()) * animationProgres));
+            for (int j = 0; j < 65; ++j)
+            {
+                const int offset = (i - 3);
+                const qreal position = ((qreal) j / 64);
+
+                weights[i][j] = ((cos((((offset < 0)?(offset + 1 - position):(offset - position)) / 3) * PI) + 1) / 2);
+            }
         }
+
+        initialized = true;
     }
+
+    if (distance < -3 || distance > 3)
+    {
+        return 0;
+    }
+
+    return weights[distance + 3][qBound(0, qRound(across * 64), 64)];
 }
 
 void Applet::needsVisualFocus()
@@ -1382,6 +1674,7 @@ void Applet::hideDropZone()
 void Applet::updateSize()
 {
     QList<QGraphicsWidget*> items;
+    QList<QPointer<Icon> > zoomedIcons;
     QPointer<Separator> lastSeparator = NULL;
     QSize size;
     int separatorsGap = -1;
@@ -1400,14 +1693,9 @@ void Applet::updateSize()
 
     for (int i = 0; i < m_layout->count(); ++i)
     {
-        QObject *object = dynamic_cast<QObject*>(m_layout->itemAt(i));
+        const DockLayout::ItemKind kind = m_layout->kind(i);
 
-        if (!object)
-        {
-            continue;
-        }
-
-        if (object->objectName() == "FancyTasksDropZone")
+        if (kind == DockLayout::DropZoneItem)
         {
             if (m_dropZone->isVisible())
             {
@@ -1417,14 +1705,9 @@ void Applet::updateSize()
             continue;
         }
 
-        if (object->objectName() == "FancyTasksSeparator")
+        if (kind == DockLayout::SeparatorItem)
         {
-            Separator *separator = dynamic_cast<Separator*>(m_layout->itemAt(i)->graphicsItem());
-
-            if (!separator)
-            {
-                continue;
-            }
+            Separator *separator = static_cast<Separator*>(m_layout->widgetAt(i));
 
             items.append(separator);
 
@@ -1446,17 +1729,22 @@ void Applet::updateSize()
             continue;
         }
 
-        if (object->objectName() == "FancyTasksIcon")
+        if (kind == DockLayout::IconItem)
         {
-            Icon *icon = static_cast<Icon*>(m_layout->itemAt(i)->graphicsItem());
+            Icon *icon = static_cast<Icon*>(m_layout->widgetAt(i));
 
-            if (!icon || !icon->isVisible())
+            if (!icon->isVisible())
             {
                 continue;
             }
 
             items.append(icon);
 
+            if (icon->factor() != icon->restingFactor())
+            {
+                zoomedIcons.append(icon);
+            }
+
             if (separatorsGap >= 0)
             {
                 ++separatorsGap;
@@ -1481,6 +1769,13 @@ void Applet::updateSize()
     }
 
     m_visibleItems = items;
+    m_visibleIndexes.clear();
+    m_zoomedIcons = zoomedIcons;
+
+    for (int i = 0; i < m_visibleItems.count(); ++i)
+    {
+        m_visibleIndexes[m_visibleItems.at(i)] = i;
+    }
 
     m_appletMaximumWidth *= 0.9;
 
@@ -1518,21 +1813,28 @@ void Applet::updateSize()
 
     update();
 
+    beginLayoutTransaction();
+
     emit sizeChanged(m_itemSize);
+
+    commitLayoutTransaction();
 }
 
 void Applet::updateTheme()
 {
-    m_lightPixmap = QPixmap(m_theme->elementSize("task"));
-    m_lightPixmap.fill(Qt::transparent);
+    ++m_cacheRevision;
 
-    QPainter pixmapPainter(&m_lightPixmap);
-    pixmapPainter.setRenderHints(QPainter::SmoothPixmapTransform);
+    m_themePixmaps.clear();
+    m_progressPixmaps.clear();
 
-    m_theme->paint(&pixmapPainter, m_lightPixmap.rect(), "task");
+    update();
+}
 
-    pixmapPainter.end();
+void Applet::updateRules()
+{
+    m_ruleMatcher.invalidate();
 }
+
 void Applet::itemDropped(Icon *icon, int index)
 {
     if (!icon)
@@ -1593,34 +1895,9 @@ void Applet::itemDragged(Icon *icon, const QPointF &position, const QMimeData *m
         return;
     }
 
-    QList<int> items;
-
-    for (int i = 0; i < m_layout->count(); ++i)
-    {
-        QObject *object = dynamic_cast<QObject*>(m_layout->itemAt(i)->graphicsItem());
-
-        if (!object)
-        {
-            continue;
-        }
-
-        if (object->objectName() == "FancyTasksIcon")
-        {
-            Icon *currentIcon = dynamic_cast<Icon*>(object);
-
-            if (currentIcon)
-            {
-                items.append(currentIcon->id());
-            }
-        }
-        else if (object->objectName() == "FancyTasksSeparator")
-        {
-            items.append(-1);
-        }
-    }
-
-    int index = items.indexOf(icon->id());
-    const int draggedIndex = items.indexOf(mimeData->hasFormat("plasmoid-fancytasks/iconid")?QString(mimeData->data("plasmoid-fancytasks/iconid")).toInt():-1);
+    Icon *draggedIcon = (mimeData->hasFormat("plasmoid-fancytasks/iconid")?m_icons.value(QString(mimeData->data("plasmoid-fancytasks/iconid")).toInt()).data():NULL);
+    int index = m_layout->itemIndex(icon);
+    const int draggedIndex = (draggedIcon?m_layout->itemIndex(draggedIcon):-1);
 
     if (index < 0 || icon->id() < 0 || (index >= (draggedIndex - 1) && index <= (draggedIndex + 1)))
     {
@@ -1775,7 +2052,7 @@ Task* Applet::taskForWindow(WId window)
     return m_tasks[window];
 }
 
-Launcher* Applet::launcherForUrl(KUrl url)
+Launcher* Applet::launcherForUrl(KUrl url, bool deferred)
 {
     Launcher *launcher = NULL;
 
@@ -1796,13 +2073,25 @@ Launcher* Applet::launcherForUrl(KUrl url)
 
     if (!launcher)
     {
-        launcher = new Launcher(url, this);
+        launcher = new Launcher(url, this, deferred);
 
         updateLauncher(launcher);
 
         connect(launcher, SIGNAL(launcherChanged(Launcher*,KUrl)), this, SLOT(changeLauncher(Launcher*,KUrl)));
+        connect(launcher, SIGNAL(rulesChanged()), this, SLOT(updateRules()));
+        connect(launcher, SIGNAL(destroyed()), this, SLOT(updateRules()));
+
+        if (deferred)
+        {
+            connect(launcher, SIGNAL(resolved()), this, SLOT(launcherResolved()));
+            connect(launcher, SIGNAL(destroyed()), this, SLOT(launcherResolved()));
+
+            m_pendingLaunchers.append(launcher);
+        }
 
         m_launchers.append(launcher);
+
+        updateRules();
     }
 
     return launcher;
@@ -1815,55 +2104,24 @@ Launcher* Applet::launcherForTask(Task *task)
         return NULL;
     }
 
+    if (!m_ruleMatcher.isValid())
+    {
+        m_ruleMatcher.compile(m_launchers);
+    }
+
     QMap<ConnectionRule, QString> values;
     values[TaskCommandRule] = task->command();
     values[TaskTitleRule] = task->title();
 
     if (task->windows().count() > 0)
     {
-        const WId window = task->windows().first();
-
-        values[WindowClassRule] = KWindowSystem::windowInfo(window, 0, NET::WM2WindowClass).windowClassName();
-        values[WindowRoleRule] = KWindowSystem::windowInfo(window, 0, NET::WM2WindowClass).windowClassClass();
-    }
-    else
-    {
-        values[WindowClassRule] = QString();
-        values[WindowRoleRule] = QString();
-    }
-
-    for (int i = 0; i < m_launchers.count(); ++i)
-    {
-        if (m_launchers.at(i)->isMenu() || m_launchers.at(i)->isExcluded() || m_launchers.at(i)->rules().isEmpty())
-        {
-            continue;
-        }
-
-        QMap<ConnectionRule, LauncherRule> rules = m_launchers.at(i)->rules();
-        QMap<ConnectionRule, LauncherRule>::iterator iterator;
-        int matched = 0;
-
-        for (iterator = rules.begin(); iterator != rules.end(); ++iterator)
-        {
-            if (!values[iterator.key()].isEmpty() && matchRule(iterator.value().expression, values[iterator.key()], iterator.value().match))
-            {
-                ++matched;
-            }
-            else if (iterator.value().required)
-            {
-                matched = 0;
+        const WindowProperties properties = m_manager->properties(task->windows().first());
 
-                break;
-            }
-        }
-
-        if (matched > 0)
-        {
-            return m_launchers.at(i);
-        }
+        values[WindowClassRule] = properties.windowName;
+        values[WindowRoleRule] = properties.windowClass;
     }
 
-    return NULL;
+    return m_ruleMatcher.match(values);
 }
 
 Icon* Applet::iconForMimeData(const QMimeData *mimeData)
@@ -1872,9 +2130,9 @@ Icon* Applet::iconForMimeData(const QMimeData *mimeData)
     {
         const int id = QString(mimeData->data("plasmoid-fancytasks/iconid")).toInt();
 
-        if (m_icons.contains(id))
+        if (m_icons.value(id))
         {
-            return m_icons[id];
+            return m_icons.value(id);
         }
     }
 
@@ -1928,24 +2186,27 @@ Icon* Applet::iconForMimeData(const QMimeData *mimeData)
         }
     }
 
-    qSort(sourceWindows);
+    const QSet<WId> windows = sourceWindows.toSet();
+    quint64 fingerprint = 0;
+    QSet<WId>::const_iterator windowsIterator;
 
-    QMap<TaskManager::AbstractGroupableItem*, QPointer<Icon> >::iterator iterator;
+    for (windowsIterator = windows.constBegin(); windowsIterator != windows.constEnd(); ++windowsIterator)
+    {
+        fingerprint ^= Icon::windowHash(*windowsIterator);
+    }
 
-    for (iterator = m_taskIcons.begin(); iterator != m_taskIcons.end(); ++iterator)
+    const QList<QPointer<Icon> > candidates = m_windowIcons.values(fingerprint);
+
+    for (int i = 0; i < candidates.count(); ++i)
     {
-        if (!iterator.value() || (iterator.value()->itemType() != TaskType && iterator.value()->itemType() != GroupType))
+        if (!candidates.at(i) || (candidates.at(i)->itemType() != TaskType && candidates.at(i)->itemType() != GroupType) || m_iconKeys.value(candidates.at(i)).tasks.isEmpty())
         {
             continue;
         }
 
-        QList<WId> targetWindows = iterator.value()->task()->windows();
-
-        qSort(targetWindows);
-
-        if (sourceWindows == targetWindows)
+        if (candidates.at(i)->windows() == windows)
         {
-            return iterator.value();
+            return candidates.at(i);
         }
     }
 
@@ -1981,13 +2242,198 @@ Icon* Applet::createIcon(Task *task, Launcher *launcher, Job *job)
     connect(icon, SIGNAL(hoverLeft()), this, SLOT(hoverLeft()));
     connect(icon, SIGNAL(visibilityChanged(bool)), this, SLOT(updateSize()));
     connect(icon, SIGNAL(destroyed()), this, SLOT(updateSize()));
-    connect(icon, SIGNAL(destroyed()), this, SLOT(cleanup()));
+    connect(icon, SIGNAL(destroyed(QObject*)), this, SLOT(removeIcon(QObject*)));
+    connect(icon, SIGNAL(geometryChanged()), this, SLOT(iconGeometryChanged()));
 
     m_icons[id] = icon;
+    m_iconKeys[icon].id = id;
+    m_iconKeys[icon].windows = icon->windowsFingerprint();
 
     return icon;
 }
 
+void Applet::setTaskIcon(AbstractGroupableItem *abstractItem, Icon *icon)
+{
+    removeTaskIcon(abstractItem);
+
+    m_taskIcons[abstractItem] = icon;
+
+    if (icon)
+    {
+        m_iconKeys[icon].tasks.append(abstractItem);
+
+        indexApplication(icon);
+    }
+}
+
+void Applet::setLauncherTaskIcon(AbstractGroupableItem *abstractItem, Icon *icon)
+{
+    removeLauncherTaskIcon(abstractItem);
+
+    m_launcherTaskIcons[abstractItem] = icon;
+
+    if (icon)
+    {
+        m_iconKeys[icon].launcherTasks.append(abstractItem);
+    }
+}
+
+void Applet::setJobIcon(Job *job, Icon *icon)
+{
+    removeJobIcon(job);
+
+    m_jobIcons[job] = icon;
+
+    if (icon)
+    {
+        m_iconKeys[icon].jobs.append(job);
+
+        if (job && !m_applicationJobIcons.value(job->application()))
+        {
+            m_applicationJobIcons[job->application()] = icon;
+        }
+    }
+}
+
+void Applet::removeTaskIcon(AbstractGroupableItem *abstractItem)
+{
+    Icon *icon = m_taskIcons.take(abstractItem);
+
+    if (icon && m_iconKeys.contains(icon))
+    {
+        m_iconKeys[icon].tasks.removeAll(abstractItem);
+
+        indexApplication(icon);
+    }
+}
+
+void Applet::removeLauncherTaskIcon(AbstractGroupableItem *abstractItem)
+{
+    Icon *icon = m_launcherTaskIcons.take(abstractItem);
+
+    if (icon && m_iconKeys.contains(icon))
+    {
+        m_iconKeys[icon].launcherTasks.removeAll(abstractItem);
+    }
+}
+
+void Applet::removeJobIcon(Job *job)
+{
+    Icon *icon = m_jobIcons.take(job);
+
+    if (icon && m_iconKeys.contains(icon))
+    {
+        m_iconKeys[icon].jobs.removeAll(job);
+    }
+
+    if (!job || !icon || m_applicationJobIcons.value(job->application()) != icon)
+    {
+        return;
+    }
+
+    const QList<QPointer<Job> > jobs = icon->jobs();
+
+    for (int i = 0; i < jobs.count(); ++i)
+    {
+        if (jobs.at(i) && jobs.at(i) != job && jobs.at(i)->application() == job->application())
+        {
+            return;
+        }
+    }
+
+    m_applicationJobIcons.remove(job->application());
+}
+
+void Applet::indexApplication(Icon *icon)
+{
+    if (!m_iconKeys.contains(icon))
+    {
+        return;
+    }
+
+    IconKeys &keys = m_iconKeys[icon];
+    QString application;
+    WId window = 0;
+
+    if (!keys.tasks.isEmpty() && icon->task() && (icon->itemType() == TaskType || icon->itemType() == GroupType))
+    {
+        window = icon->task()->windows().value(0, 0);
+
+        if (window)
+        {
+            application = applicationKey(m_manager->properties(window).windowName);
+        }
+    }
+
+    if (window == keys.window && application == keys.application)
+    {
+        return;
+    }
+
+    if (keys.window && m_applicationWindows.value(keys.window) == icon)
+    {
+        m_applicationWindows.remove(keys.window);
+    }
+
+    if (!keys.application.isEmpty())
+    {
+        m_applicationIcons.remove(keys.application, icon);
+    }
+
+    keys.window = window;
+    keys.application = application;
+
+    if (window)
+    {
+        m_applicationWindows[window] = icon;
+    }
+
+    if (!application.isEmpty())
+    {
+        m_applicationIcons.insert(application, icon);
+    }
+}
+
+Icon* Applet::applicationIcon(const QString &application) const
+{
+    const QString key = applicationKey(application);
+
+    if (key.isEmpty())
+    {
+        return NULL;
+    }
+
+    QMultiHash<QString, QPointer<Icon> >::const_iterator iterator = m_applicationIcons.find(key);
+
+    while (iterator != m_applicationIcons.end() && iterator.key() == key)
+    {
+        if (iterator.value())
+        {
+            return iterator.value();
+        }
+
+        ++iterator;
+    }
+
+    return NULL;
+}
+
+QString Applet::applicationKey(const QString &application)
+{
+    QString key;
+    key.reserve(application.length());
+
+    for (int i = 0; i < application.length(); ++i)
+    {
+        if (application.at(i).isLetter())
+        {
+            key.append(application.at(i).toLower());
+        }
+    }
+
+    return key;
+}
+
 QStringList Applet::arrangement() const
 {
     return m_arrangement;
@@ -2043,57 +2489,298 @@ QList<QAction*> Applet::contextualActions()
     return actions;
 }
 
-QPixmap Applet::lightPixmap()
+QPixmap Applet::themePixmap(const QString &element, const QSize &size)
+{
+    if (size.width() < 1 || size.height() < 1)
+    {
+        return QPixmap();
+    }
+
+    const QString key = QString("%1 %2x%3 %4").arg(element).arg(size.width()).arg(size.height()).arg(m_cacheRevision);
+    QPixmap *pixmap = m_themePixmaps.object(key);
+
+    if (pixmap)
+    {
+        return *pixmap;
+    }
+
+    pixmap = new QPixmap(size);
+    pixmap->fill(Qt::transparent);
+
+    QPainter pixmapPainter(pixmap);
+    pixmapPainter.setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing);
+
+    m_theme->paint(&pixmapPainter, QRectF(QPointF(0, 0), size), element);
+
+    pixmapPainter.end();
+
+    const QPixmap result = *pixmap;
+
+    m_themePixmaps.insert(key, pixmap, (size.width() * size.height() * 4));
+
+    return result;
+}
+
+QPixmap Applet::progressFrames(const QSize &size, int steps)
 {
-    return m_lightPixmap;
+    if (size.width() < 1 || size.height() < 1 || steps < 1)
+    {
+        return QPixmap();
+    }
+
+    const QString key = QString("progress %1x%2 %3 %4").arg(size.width()).arg(size.height()).arg(steps).arg(m_cacheRevision);
+    QPixmap *pixmap = m_progressPixmaps.object(key);
+
+    if (pixmap)
+    {
+        return *pixmap;
+    }
+
+    const QPixmap progressPixmap = themePixmap("progress", size);
+
+    pixmap = new QPixmap((size.width() * steps), size.height());
+    pixmap->fill(Qt::transparent);
+
+    QPainter pixmapPainter(pixmap);
+    pixmapPainter.setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing);
+
+    for (int i = 0; i < steps; ++i)
+    {
+        pixmapPainter.save();
+        pixmapPainter.translate(((i + 0.5) * size.width()), (size.height() * 0.5));
+        pixmapPainter.rotate((360.0 * i) / steps);
+        pixmapPainter.drawPixmap(QPointF(-(size.width() * 0.5), -(size.height() * 0.5)), progressPixmap);
+        pixmapPainter.restore();
+    }
+
+    pixmapPainter.end();
+
+    const QPixmap result = *pixmap;
+
+    m_progressPixmaps.insert(key, pixmap, (pixmap->width() * pixmap->height() * 4));
+
+    return result;
 }
 
 WId Applet::window() const
 {
-    if (scene())
+    QGraphicsView *view = parentView();
+
+    return (view?view->winId():0);
+}
+
+QGraphicsView* Applet::parentView() const
+{
+    if (!scene())
     {
-        QGraphicsView *parentView = NULL;
-        QGraphicsView *possibleParentView = NULL;
+        return NULL;
+    }
+
+    QGraphicsView *possibleParentView = NULL;
 
-        foreach (QGraphicsView *view, scene()->views())
+    foreach (QGraphicsView *view, scene()->views())
+    {
+        if (view->sceneRect().intersects(sceneBoundingRect()) || view->sceneRect().contains(scenePos()))
         {
-            if (view->sceneRect().intersects(sceneBoundingRect()) || view->sceneRect().contains(scenePos()))
+            if (view->isActiveWindow())
             {
-                if (view->isActiveWindow())
-                {
-                    parentView = view;
-
-                    break;
-                }
-                else
-                {
-                    possibleParentView = view;
-                }
+                return view;
             }
+
+            possibleParentView = view;
+        }
+    }
+
+    return possibleParentView;
+}
+
+qreal Applet::initialFactor() const
+{
+    return m_initialFactor;
+}
+
+qreal Applet::itemSize() const
+{
+    return m_itemSize;
+}
+
+int Applet::cacheRevision() const
+{
+    return m_cacheRevision;
+}
+
+int Applet::suppressedJobs() const
+{
+    return m_suppressedJobs;
+}
+
+int Applet::coalescedJobs() const
+{
+    return m_coalescedJobs;
+}
+
+bool Applet::reserveFrameCache(Icon *icon, int cost)
+{
+    m_frameCacheCost -= m_frameCosts.take(icon);
+
+    if ((m_frameCacheCost + cost) > m_frameCacheLimit)
+    {
+        return false;
+    }
+
+    m_frameCacheCost += cost;
+
+    m_frameCosts[icon] = cost;
+
+    return true;
+}
+
+void Applet::registerAnimation(Icon *icon)
+{
+    if (!m_animatedIcons.contains(icon))
+    {
+        m_animatedIcons.append(icon);
+    }
+
+    startAnimationClock();
+}
+
+void Applet::indexWindows(Icon *icon, quint64 previousFingerprint)
+{
+    if (previousFingerprint)
+    {
+        m_windowIcons.remove(previousFingerprint, icon);
+    }
+
+    if (icon->windowsFingerprint())
+    {
+        m_windowIcons.insert(icon->windowsFingerprint(), icon);
+    }
+
+    if (m_iconKeys.contains(icon))
+    {
+        m_iconKeys[icon].windows = icon->windowsFingerprint();
+    }
+
+    indexApplication(icon);
+}
+
+void Applet::scheduleGeometryUpdate(Icon *icon)
+{
+    if (icon->task() && !m_geometryIcons.contains(icon))
+    {
+        m_geometryIcons.append(icon);
+    }
+
+    if (m_geometryIcons.isEmpty())
+    {
+        return;
+    }
+
+    if (m_geometryTimer)
+    {
+        killTimer(m_geometryTimer);
+    }
+
+    m_geometryTimer = startTimer(250);
+}
+
+void Applet::iconGeometryChanged()
+{
+    Icon *icon = qobject_cast<Icon*>(sender());
+
+    if (icon)
+    {
+        scheduleGeometryUpdate(icon);
+    }
+}
+
+void Applet::appletGeometryChanged()
+{
+    QHash<AbstractGroupableItem*, QPointer<Icon> >::const_iterator iterator;
+
+    for (iterator = m_taskIcons.constBegin(); iterator != m_taskIcons.constEnd(); ++iterator)
+    {
+        if (iterator.value())
+        {
+            scheduleGeometryUpdate(iterator.value());
         }
+    }
+
+    for (iterator = m_launcherTaskIcons.constBegin(); iterator != m_launcherTaskIcons.constEnd(); ++iterator)
+    {
+        if (iterator.value())
+        {
+            scheduleGeometryUpdate(iterator.value());
+        }
+    }
+}
+
+void Applet::beginLayoutTransaction()
+{
+    ++m_layoutTransactions;
+}
+
+void Applet::commitLayoutTransaction()
+{
+    if (m_layoutTransactions > 0)
+    {
+        --m_layoutTransactions;
+    }
+
+    if (m_layoutTransactions > 0 || m_pendingSizes.isEmpty())
+    {
+        return;
+    }
+
+    const QHash<QGraphicsWidget*, QSizeF> pendingSizes = m_pendingSizes;
+    QHash<QGraphicsWidget*, QSizeF>::const_iterator iterator;
+    int first = -1;
+
+    m_pendingSizes.clear();
 
-        if (!parentView)
+    for (iterator = pendingSizes.constBegin(); iterator != pendingSizes.constEnd(); ++iterator)
+    {
+        if (iterator.key()->preferredSize() == iterator.value())
         {
-            parentView = possibleParentView;
+            continue;
         }
 
-        if (parentView)
+        const int index = m_layout->resizeItem(iterator.key(), iterator.value());
+
+        if (index < 0)
         {
-            return parentView->winId();
+            iterator.key()->setPreferredSize(iterator.value());
+        }
+        else if (first < 0 || index < first)
+        {
+            first = index;
         }
     }
 
-    return 0;
+    if (first >= 0)
+    {
+        m_layout->arrange(first);
+    }
 }
 
-qreal Applet::initialFactor() const
+qint64 Applet::animationTime() const
 {
-    return m_initialFactor;
+    return m_animationClock.elapsed();
 }
 
-qreal Applet::itemSize() const
+bool Applet::deferPreferredSize(QGraphicsWidget *item, const QSizeF &size)
 {
-    return m_itemSize;
+    if (!m_layoutTransactions)
+    {
+        return false;
+    }
+
+    connect(item, SIGNAL(destroyed(QObject*)), this, SLOT(removePendingSize(QObject*)), Qt::UniqueConnection);
+
+    m_pendingSizes[item] = size;
+
+    return true;
 }
 
 bool Applet::focusNextPrevChild(bool next)
@@ -2113,21 +2800,4 @@ bool Applet::paintReflections() const
     return m_paintReflections;
 }
 
-bool Applet::matchRule(const QString &expression, const QString &value, RuleMatch match)
-{
-    switch (match)
-    {
-        case ExactMatch:
-            return (expression == value);
-        case PartialMatch:
-            return value.contains(expression);
-        case RegExpMatch:
-            return QRegExp(expression, Qt::CaseInsensitive).exactMatch(value);
-        default:
-            return false;
-    }
-
-    return false;
-}
-
 }
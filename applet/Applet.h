@@ -22,15 +22,21 @@
 #define FANCYTASKSAPPLET_HEADER
 
 #include "Constants.h"
+#include "RuleMatcher.h"
+#include "StartupMatcher.h"
+#include "DockLayout.h"
+#include "Manager.h"
 
 #include <QtCore/QHash>
+#include <QtCore/QCache>
 #include <QtCore/QQueue>
 #include <QtCore/QPointer>
 #include <QtCore/QDateTime>
 #include <QtCore/QMimeData>
-#include <QtCore/QTimeLine>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTimerEvent>
 #include <QtGui/QFocusEvent>
-#include <QtGui/QGraphicsLinearLayout>
+#include <QtGui/QGraphicsView>
 #include <QtGui/QGraphicsSceneMouseEvent>
 #include <QtGui/QGraphicsSceneResizeEvent>
 #include <QtGui/QGraphicsSceneDragDropEvent>
@@ -75,7 +81,7 @@ class Applet : public Plasma::Applet
         void itemDragged(Icon *icon, const QPointF &position, const QMimeData *mimeData);
         KMenu* contextMenu();
         Task* taskForWindow(WId window);
-        Launcher* launcherForUrl(KUrl url);
+        Launcher* launcherForUrl(KUrl url, bool deferred = false);
         Launcher* launcherForTask(Task *task);
         Icon* iconForMimeData(const QMimeData *mimeData);
         TaskManager::GroupManager* groupManager();
@@ -88,13 +94,25 @@ class Applet : public Plasma::Applet
         AnimationType startupAnimation() const;
         QMap<QPair<Qt::MouseButtons, Qt::KeyboardModifiers>, IconAction> iconActions() const;
         QList<QAction*> contextualActions();
-        QPixmap lightPixmap();
+        QPixmap themePixmap(const QString &element, const QSize &size);
+        QPixmap progressFrames(const QSize &size, int steps);
         WId window() const;
+        QGraphicsView* parentView() const;
         qreal initialFactor() const;
+        int cacheRevision() const;
+        int suppressedJobs() const;
+        int coalescedJobs() const;
         qreal itemSize() const;
         bool parabolicMoveAnimation() const;
         bool paintReflections() const;
-        static bool matchRule(const QString &expression, const QString &value, RuleMatch match);
+        bool reserveFrameCache(Icon *icon, int cost);
+        void registerAnimation(Icon *icon);
+        void indexWindows(Icon *icon, quint64 previousFingerprint);
+        void scheduleGeometryUpdate(Icon *icon);
+        void beginLayoutTransaction();
+        void commitLayoutTransaction();
+        qint64 animationTime() const;
+        bool deferPreferredSize(QGraphicsWidget *item, const QSizeF &size);
 
     public slots:
         void configChanged();
@@ -109,6 +127,20 @@ class Applet : public Plasma::Applet
         void requestFocus();
 
     protected:
+        struct IconKeys
+        {
+            IconKeys();
+
+            QList<AbstractGroupableItem*> tasks;
+            QList<AbstractGroupableItem*> launcherTasks;
+            QList<Job*> jobs;
+            QString application;
+            quint64 windows;
+            WId window;
+            Launcher *launcher;
+            int id;
+        };
+
         void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
         void createConfigurationInterface(KConfigDialog *parent);
         void constraintsEvent(Plasma::Constraints constraints);
@@ -120,43 +152,83 @@ class Applet : public Plasma::Applet
         void mousePressEvent(QGraphicsSceneMouseEvent *event);
         void wheelEvent(QGraphicsSceneWheelEvent *event);
         void focusInEvent(QFocusEvent *event);
+        void timerEvent(QTimerEvent *event);
+        void startAnimationClock();
         void focusIcon(bool next, bool activateWindow = false);
         Icon* createIcon(Task *task, Launcher *launcher, Job *job);
+        void zoomIcon(Icon *icon, qreal factor, qreal progress);
         bool focusNextPrevChild(bool next);
+        void setTaskIcon(AbstractGroupableItem *abstractItem, Icon *icon);
+        void setLauncherTaskIcon(AbstractGroupableItem *abstractItem, Icon *icon);
+        void setJobIcon(Job *job, Icon *icon);
+        void removeTaskIcon(AbstractGroupableItem *abstractItem);
+        void removeLauncherTaskIcon(AbstractGroupableItem *abstractItem);
+        void removeJobIcon(Job *job);
+        void addTasks();
+        void showJob(Job *job);
+        void showJobs(qint64 time);
+        void scheduleJobs();
+        void indexApplication(Icon *icon);
+        Icon* applicationIcon(const QString &application) const;
+        static qreal zoomWeight(int distance, qreal across);
+        static QString applicationKey(const QString &application);
 
     protected slots:
         void insertItem(int index, QGraphicsLayoutItem *item);
-        void checkStartup();
-        void addTask(AbstractGroupableItem *abstractItem, bool force = false);
+        void addTask(AbstractGroupableItem *abstractItem);
+        void resolveStartup();
         void removeTask(AbstractGroupableItem *abstractItem);
         void changeTaskPosition(AbstractGroupableItem *abstractItem);
-        void showJob();
-        void cleanup();
+        void removeIcon(QObject *object);
+        void removePendingSize(QObject *object);
+        void updateApplications(const QList<WId> &windows);
+        void iconGeometryChanged();
+        void appletGeometryChanged();
         void reload();
+        void launcherResolved();
         void itemHoverMoved(QGraphicsWidget *item, qreal across);
         void hoverLeft();
         void moveAnimation(int progress);
         void showMenu();
         void updateSize();
         void updateTheme();
+        void updateRules();
 
     private:
-        QGraphicsLinearLayout *m_layout;
+        DockLayout *m_layout;
         GroupManager *m_groupManager;
-        QQueue<QPointer<Task> > m_startupsQueue;
-        QQueue<QPointer<Job> > m_jobsQueue;
+        Manager *m_manager;
+        QQueue<QPair<qint64, QPointer<Job> > > m_jobsQueue;
+        QQueue<QPair<qint64, QPointer<Job> > > m_closingJobs;
         QList<QGraphicsWidget*> m_visibleItems;
+        QHash<QGraphicsWidget*, int> m_visibleIndexes;
         QList<QPointer<Launcher> > m_launchers;
-        QMap<WId, QPointer<Task> > m_tasks;
-        QMap<QString, QPointer<Job> > m_jobs;
-        QMap<int, QPointer<Icon> > m_icons;
-        QMap<AbstractGroupableItem*, QPointer<Icon> > m_taskIcons;
-        QMap<AbstractGroupableItem*, QPointer<Icon> > m_launcherTaskIcons;
-        QMap<Launcher*, QPointer<Icon> > m_launcherIcons;
-        QMap<Job*, QPointer<Icon> > m_jobIcons;
+        QList<QPointer<Launcher> > m_pendingLaunchers;
+        QList<QPointer<Icon> > m_animatedIcons;
+        QList<QPointer<Icon> > m_zoomedIcons;
+        QList<QPointer<Icon> > m_geometryIcons;
+        QHash<WId, QPointer<Task> > m_tasks;
+        QHash<QString, QPointer<Job> > m_jobs;
+        QHash<int, QPointer<Icon> > m_icons;
+        QHash<QObject*, int> m_frameCosts;
+        QHash<AbstractGroupableItem*, QPointer<Icon> > m_taskIcons;
+        QHash<AbstractGroupableItem*, QPointer<Icon> > m_launcherTaskIcons;
+        QHash<Launcher*, QPointer<Icon> > m_launcherIcons;
+        QHash<Job*, QPointer<Icon> > m_jobIcons;
+        QHash<QObject*, IconKeys> m_iconKeys;
+        QMultiHash<quint64, QPointer<Icon> > m_windowIcons;
+        QMultiHash<QString, QPointer<Icon> > m_applicationIcons;
+        QHash<QString, QPointer<Icon> > m_applicationJobIcons;
+        QHash<WId, QPointer<Icon> > m_applicationWindows;
         QMap<QPair<Qt::MouseButtons, Qt::KeyboardModifiers>, IconAction> m_iconActions;
+        QHash<QGraphicsWidget*, QSizeF> m_pendingSizes;
+        RuleMatcher m_ruleMatcher;
+        StartupMatcher m_startupMatcher;
         QDateTime m_lastAttentionDemand;
-        QPixmap m_lightPixmap;
+        QElapsedTimer m_animationClock;
+        QPointer<QGraphicsWidget> m_hoveredItem;
+        QCache<QString, QPixmap> m_themePixmaps;
+        QCache<QString, QPixmap> m_progressPixmaps;
         QSize m_size;
         Plasma::FrameSvg *m_theme;
         Plasma::FrameSvg *m_background;
@@ -164,7 +236,6 @@ class Applet : public Plasma::Applet
         QAction *m_entriesAction;
         QString m_customBackgroundImage;
         QStringList m_arrangement;
-        QTimeLine *m_animationTimeLine;
         TitleLabelMode m_titleLabelMode;
         CloseJobMode m_jobCloseMode;
         ActiveIconIndication m_activeIconIndication;
@@ -175,10 +246,22 @@ class Applet : public Plasma::Applet
         qreal m_appletMaximumHeight;
         qreal m_initialFactor;
         qreal m_across;
+        qreal m_hoveredAcross;
         qreal m_itemSize;
         int m_activeItem;
         int m_focusedItem;
+        int m_animationTimer;
+        int m_geometryTimer;
+        int m_jobsTimer;
+        int m_layoutTransactions;
+        qint64 m_hoverAnimationStart;
+        int m_cacheRevision;
+        int m_frameCacheCost;
+        int m_frameCacheLimit;
+        int m_suppressedJobs;
+        int m_coalescedJobs;
         bool m_initialized;
+        bool m_tasksDeferred;
         bool m_parabolicMoveAnimation;
         bool m_showOnlyTasksWithLaunchers;
         bool m_connectJobsWithTasks;
@@ -0,0 +1,126 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "CommandResolver.h"
+
+#include <QtCore/QFile>
+
+#include <KGlobal>
+
+namespace FancyTasks
+{
+
+K_GLOBAL_STATIC(CommandResolver, commandResolver)
+
+CommandResolver::CommandResolver()
+{
+    m_purgeTimer.start();
+}
+
+void CommandResolver::purge()
+{
+    QHash<int, QPair<qulonglong, QString> >::iterator iterator = m_commands.begin();
+
+    while (iterator != m_commands.end())
+    {
+        if (startTime(iterator.key()) != iterator.value().first)
+        {
+            iterator = m_commands.erase(iterator);
+        }
+        else
+        {
+            ++iterator;
+        }
+    }
+
+    m_purgeTimer.restart();
+}
+
+QString CommandResolver::command(int pid)
+{
+    if (pid <= 0)
+    {
+        return QString();
+    }
+
+    if (m_purgeTimer.elapsed() > 60000)
+    {
+        purge();
+    }
+
+    const qulonglong processStartTime = startTime(pid);
+
+    if (!processStartTime)
+    {
+        m_commands.remove(pid);
+
+        return QString();
+    }
+
+    if (m_commands.contains(pid) && m_commands[pid].first == processStartTime)
+    {
+        return m_commands[pid].second;
+    }
+
+    QFile file(QString("/proc/%1/cmdline").arg(pid));
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QString();
+    }
+
+    QByteArray data = file.readAll();
+    data.replace('\0', ' ');
+
+    const QString command = QString::fromLocal8Bit(data).trimmed();
+
+    m_commands[pid] = qMakePair(processStartTime, command);
+
+    return command;
+}
+
+CommandResolver* CommandResolver::self()
+{
+    return commandResolver;
+}
+
+qulonglong CommandResolver::startTime(int pid)
+{
+    QFile file(QString("/proc/%1/stat").arg(pid));
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return 0;
+    }
+
+    const QByteArray data = file.readAll();
+    const int position = data.lastIndexOf(')');
+
+    if (position < 0)
+    {
+        return 0;
+    }
+
+    const QList<QByteArray> fields = data.mid(position + 2).split(' ');
+
+    return ((fields.count() > 19)?fields.at(19).toULongLong():0);
+}
+
+}
@@ -0,0 +1,51 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#ifndef FANCYTASKSCOMMANDRESOLVER_HEADER
+#define FANCYTASKSCOMMANDRESOLVER_HEADER
+
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+#include <QtCore/QElapsedTimer>
+
+namespace FancyTasks
+{
+
+class CommandResolver
+{
+    public:
+        CommandResolver();
+
+        QString command(int pid);
+        static CommandResolver* self();
+
+    protected:
+        void purge();
+        static qulonglong startTime(int pid);
+
+    private:
+        QHash<int, QPair<qulonglong, QString> > m_commands;
+        QElapsedTimer m_purgeTimer;
+};
+
+}
+
+#endif
@@ -0,0 +1,423 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "DockLayout.h"
+#include "Icon.h"
+#include "Separator.h"
+#include "DropZone.h"
+
+#include <QtGui/QWidget>
+#include <QtGui/QGraphicsWidget>
+
+namespace FancyTasks
+{
+
+DockLayout::DockLayout(QGraphicsLayoutItem *parent) : QGraphicsLayout(parent),
+    m_orientation(Qt::Horizontal),
+    m_fixedExtent(0),
+    m_marginExtent(0),
+    m_margins(0),
+    m_updating(false)
+{
+}
+
+DockLayout::~DockLayout()
+{
+    for (int i = (m_items.count() - 1); i >= 0; --i)
+    {
+        QGraphicsLayoutItem *item = m_items.at(i);
+
+        removeAt(i);
+
+        if (item && item->ownedByLayout())
+        {
+            delete item;
+        }
+    }
+}
+
+void DockLayout::addItem(QGraphicsLayoutItem *item)
+{
+    insertItem(-1, item);
+}
+
+void DockLayout::insertItem(int index, QGraphicsLayoutItem *item)
+{
+    if (!item || m_indexes.contains(item))
+    {
+        return;
+    }
+
+    addChildLayoutItem(item);
+
+    ItemKind kind = MarginItem;
+    QGraphicsItem *graphicsItem = item->graphicsItem();
+
+    if (graphicsItem && graphicsItem->isWidget())
+    {
+        QGraphicsWidget *widget = static_cast<QGraphicsWidget*>(graphicsItem);
+
+        if (qobject_cast<Icon*>(widget))
+        {
+            kind = IconItem;
+        }
+        else if (qobject_cast<Separator*>(widget))
+        {
+            kind = SeparatorItem;
+        }
+        else if (qobject_cast<DropZone*>(widget))
+        {
+            kind = DropZoneItem;
+        }
+    }
+
+    if (index < 0 || index > m_items.count())
+    {
+        index = m_items.count();
+    }
+
+    m_items.insert(index, item);
+    m_kinds.insert(index, kind);
+    m_extents.insert(index, 0);
+
+    rebuild();
+    invalidate();
+}
+
+void DockLayout::removeItem(QGraphicsLayoutItem *item)
+{
+    const int index = indexOf(item);
+
+    if (index >= 0)
+    {
+        removeAt(index);
+    }
+}
+
+void DockLayout::removeAt(int index)
+{
+    if (index < 0 || index >= m_items.count())
+    {
+        return;
+    }
+
+    QGraphicsLayoutItem *item = m_items.at(index);
+
+    m_items.remove(index);
+    m_kinds.remove(index);
+    m_extents.remove(index);
+
+    if (item)
+    {
+        item->setParentLayoutItem(NULL);
+    }
+
+    rebuild();
+    invalidate();
+}
+
+void DockLayout::setOrientation(Qt::Orientation orientation)
+{
+    if (orientation == m_orientation)
+    {
+        return;
+    }
+
+    m_orientation = orientation;
+
+    rebuild();
+    invalidate();
+}
+
+void DockLayout::setGeometry(const QRectF &rectangle)
+{
+    QGraphicsLayout::setGeometry(rectangle);
+
+    rebuild();
+    arrange(0);
+}
+
+void DockLayout::invalidate()
+{
+    if (m_updating)
+    {
+        return;
+    }
+
+    QGraphicsLayout::invalidate();
+}
+
+void DockLayout::rebuild()
+{
+    const int count = m_items.count();
+
+    m_indexes.clear();
+    m_itemIndexes.fill(-1, count);
+    m_tree.fill(0, (count + 1));
+
+    m_fixedExtent = 0;
+    m_margins = 0;
+
+    int items = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        m_indexes[m_items.at(i)] = i;
+
+        if (m_kinds.at(i) == IconItem || m_kinds.at(i) == SeparatorItem)
+        {
+            m_itemIndexes[i] = items;
+
+            ++items;
+        }
+
+        if (m_kinds.at(i) == MarginItem)
+        {
+            ++m_margins;
+
+            m_extents[i] = m_marginExtent;
+        }
+        else
+        {
+            m_extents[i] = extent(i);
+
+            m_fixedExtent += m_extents.at(i);
+        }
+    }
+
+    for (int i = 1; i <= count; ++i)
+    {
+        m_tree[i] += m_extents.at(i - 1);
+
+        const int parent = (i + (i & -i));
+
+        if (parent <= count)
+        {
+            m_tree[parent] += m_tree.at(i);
+        }
+    }
+}
+
+void DockLayout::arrange(int first)
+{
+    const QRectF area = contentsRect();
+    const bool horizontal = (m_orientation == Qt::Horizontal);
+    const qreal available = (horizontal?area.width():area.height());
+    const qreal crossStart = (horizontal?area.top():area.left());
+    const qreal crossExtent = (horizontal?area.height():area.width());
+    const qreal marginExtent = m_marginExtent;
+
+    updateMargins(available);
+
+    if (marginExtent != m_marginExtent)
+    {
+        first = 0;
+    }
+
+    qreal position = ((horizontal?area.left():area.top()) + prefix(first));
+
+    for (int i = first; i < m_items.count(); ++i)
+    {
+        QGraphicsLayoutItem *item = m_items.at(i);
+        const QSizeF maximumSize = item->effectiveSizeHint(Qt::MaximumSize);
+        const qreal crossSize = qMin((horizontal?maximumSize.height():maximumSize.width()), crossExtent);
+        const qreal crossPosition = (crossStart + ((crossExtent - crossSize) / 2));
+
+        item->setGeometry(horizontal?QRectF(position, crossPosition, m_extents.at(i), crossSize):QRectF(crossPosition, position, crossSize, m_extents.at(i)));
+
+        position += m_extents.at(i);
+    }
+}
+
+void DockLayout::adjust(int index, qreal delta)
+{
+    for (int i = (index + 1); i < m_tree.count(); i += (i & -i))
+    {
+        m_tree[i] += delta;
+    }
+}
+
+void DockLayout::updateMargins(qreal available)
+{
+    const qreal marginExtent = (m_margins?(qMax(qreal(0), (available - m_fixedExtent)) / m_margins):0);
+
+    if (marginExtent == m_marginExtent)
+    {
+        return;
+    }
+
+    m_marginExtent = marginExtent;
+
+    for (int i = 0; i < m_items.count(); ++i)
+    {
+        if (m_kinds.at(i) == MarginItem)
+        {
+            adjust(i, (m_marginExtent - m_extents.at(i)));
+
+            m_extents[i] = m_marginExtent;
+        }
+    }
+}
+
+int DockLayout::resizeItem(QGraphicsLayoutItem *item, const QSizeF &size)
+{
+    const int index = indexOf(item);
+
+    if (index < 0)
+    {
+        return -1;
+    }
+
+    m_updating = true;
+
+    item->setPreferredSize(size);
+
+    m_updating = false;
+
+    if (m_kinds.at(index) != MarginItem)
+    {
+        const qreal delta = (extent(index) - m_extents.at(index));
+
+        if (delta != 0)
+        {
+            m_extents[index] += delta;
+            m_fixedExtent += delta;
+
+            adjust(index, delta);
+        }
+    }
+
+    return index;
+}
+
+QGraphicsLayoutItem* DockLayout::itemAt(int index) const
+{
+    if (index < 0 || index >= m_items.count())
+    {
+        return NULL;
+    }
+
+    return m_items.at(index);
+}
+
+QGraphicsWidget* DockLayout::widgetAt(int index) const
+{
+    QGraphicsLayoutItem *item = itemAt(index);
+
+    if (!item || !item->graphicsItem() || !item->graphicsItem()->isWidget())
+    {
+        return NULL;
+    }
+
+    return static_cast<QGraphicsWidget*>(item->graphicsItem());
+}
+
+QSizeF DockLayout::sizeHint(Qt::SizeHint which, const QSizeF &constraint) const
+{
+    Q_UNUSED(constraint)
+
+    if (which == Qt::MaximumSize)
+    {
+        return QSizeF(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
+    }
+
+    const bool horizontal = (m_orientation == Qt::Horizontal);
+    qreal left;
+    qreal top;
+    qreal right;
+    qreal bottom;
+    qreal mainExtent = 0;
+    qreal crossExtent = 0;
+
+    getContentsMargins(&left, &top, &right, &bottom);
+
+    for (int i = 0; i < m_items.count(); ++i)
+    {
+        const QSizeF size = m_items.at(i)->effectiveSizeHint(which);
+
+        mainExtent += (horizontal?size.width():size.height());
+        crossExtent = qMax(crossExtent, (horizontal?size.height():size.width()));
+    }
+
+    return (horizontal?QSizeF((mainExtent + left + right), (crossExtent + top + bottom)):QSizeF((crossExtent + left + right), (mainExtent + top + bottom)));
+}
+
+DockLayout::ItemKind DockLayout::kind(int index) const
+{
+    return m_kinds.value(index, MarginItem);
+}
+
+Qt::Orientation DockLayout::orientation() const
+{
+    return m_orientation;
+}
+
+QRectF DockLayout::contentsRect() const
+{
+    qreal left;
+    qreal top;
+    qreal right;
+    qreal bottom;
+
+    getContentsMargins(&left, &top, &right, &bottom);
+
+    return geometry().adjusted(left, top, -right, -bottom);
+}
+
+qreal DockLayout::extent(int index) const
+{
+    if (m_kinds.at(index) == MarginItem)
+    {
+        return m_marginExtent;
+    }
+
+    const QSizeF size = m_items.at(index)->effectiveSizeHint(Qt::PreferredSize);
+
+    return ((m_orientation == Qt::Horizontal)?size.width():size.height());
+}
+
+qreal DockLayout::prefix(int index) const
+{
+    qreal sum = 0;
+
+    for (int i = index; i > 0; i -= (i & -i))
+    {
+        sum += m_tree.at(i);
+    }
+
+    return sum;
+}
+
+int DockLayout::count() const
+{
+    return m_items.count();
+}
+
+int DockLayout::indexOf(QGraphicsLayoutItem *item) const
+{
+    return m_indexes.value(item, -1);
+}
+
+int DockLayout::itemIndex(QGraphicsLayoutItem *item) const
+{
+    return m_itemIndexes.value(indexOf(item), -1);
+}
+
+}
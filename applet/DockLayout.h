@@ -0,0 +1,87 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#ifndef FANCYTASKSDOCKLAYOUT_HEADER
+#define FANCYTASKSDOCKLAYOUT_HEADER
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QtGui/QGraphicsLayout>
+
+namespace FancyTasks
+{
+
+class DockLayout : public QGraphicsLayout
+{
+    public:
+        enum ItemKind
+        {
+            MarginItem = 0,
+            IconItem = 1,
+            SeparatorItem = 2,
+            DropZoneItem = 3
+        };
+
+        explicit DockLayout(QGraphicsLayoutItem *parent = NULL);
+        ~DockLayout();
+
+        void addItem(QGraphicsLayoutItem *item);
+        void insertItem(int index, QGraphicsLayoutItem *item);
+        void removeItem(QGraphicsLayoutItem *item);
+        void removeAt(int index);
+        void setOrientation(Qt::Orientation orientation);
+        void setGeometry(const QRectF &rectangle);
+        void invalidate();
+        QGraphicsLayoutItem* itemAt(int index) const;
+        QGraphicsWidget* widgetAt(int index) const;
+        QSizeF sizeHint(Qt::SizeHint which, const QSizeF &constraint = QSizeF()) const;
+        ItemKind kind(int index) const;
+        Qt::Orientation orientation() const;
+        int count() const;
+        int indexOf(QGraphicsLayoutItem *item) const;
+        int itemIndex(QGraphicsLayoutItem *item) const;
+        int resizeItem(QGraphicsLayoutItem *item, const QSizeF &size);
+        void arrange(int first);
+
+    protected:
+        void rebuild();
+        void adjust(int index, qreal delta);
+        void updateMargins(qreal available);
+        qreal extent(int index) const;
+        qreal prefix(int index) const;
+        QRectF contentsRect() const;
+
+    private:
+        QVector<QGraphicsLayoutItem*> m_items;
+        QVector<ItemKind> m_kinds;
+        QVector<int> m_itemIndexes;
+        QVector<qreal> m_extents;
+        QVector<qreal> m_tree;
+        QHash<QGraphicsLayoutItem*, int> m_indexes;
+        Qt::Orientation m_orientation;
+        qreal m_fixedExtent;
+        qreal m_marginExtent;
+        int m_margins;
+        bool m_updating;
+};
+
+}
+
+#endif
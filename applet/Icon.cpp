@@ -19,6 +19,7 @@
 ***********************************************************************************/
 
 #define PI 3.141592653
+#define PROGRESS_STEPS 72
 
 #include "Icon.h"
 #include "Applet.h"
@@ -27,11 +28,11 @@
 #include "Job.h"
 #include "Light.h"
 #include "Menu.h"
+#include "Reflection.h"
 
 #include <cmath>
 
 #include <QtCore/QMimeData>
-#include <QtGui/QTransform>
 #include <QtGui/QApplication>
 #include <QtGui/QGraphicsView>
 
@@ -51,30 +52,58 @@
 #include <Plasma/Theme>
 #include <Plasma/Corona>
 #include <Plasma/Animation>
+#include <Plasma/PaintUtils>
 #include <Plasma/WindowEffects>
 #include <Plasma/ToolTipManager>
 
 namespace FancyTasks
 {
 
+Icon::FrameKey::FrameKey() : visualization(0),
+    size(0),
+    visualizationSize(0),
+    width(0),
+    height(0),
+    factor(0),
+    animationType(0),
+    animationProgress(0),
+    states(0),
+    jobs(0),
+    progress(0),
+    location(0),
+    revision(0)
+{
+}
+
+bool Icon::FrameKey::operator==(const FrameKey &other) const
+{
+    return (visualization == other.visualization && size == other.size && visualizationSize == other.visualizationSize && width == other.width && height == other.height && factor == other.factor && animationType == other.animationType && animationProgress == other.animationProgress && states == other.states && jobs == other.jobs && progress == other.progress && location == other.location && revision == other.revision && label == other.label);
+}
+
 Icon::Icon(int id, Task *task, Launcher *launcher, Job *job, Applet *applet) : QGraphicsWidget(applet),
     m_applet(applet),
     m_task(NULL),
     m_launcher(NULL),
-    m_glowEffect(NULL),
     m_layout(new QGraphicsLinearLayout(this)),
-    m_animationTimeLine(new QTimeLine(1000, this)),
-    m_jobAnimationTimeLine(NULL),
     m_factor(applet->initialFactor()),
     m_animationProgress(-1),
+    m_animationStart(0),
+    m_jobsAnimationStart(0),
+    m_windowsFingerprint(0),
     m_id(id),
+    m_animationDuration(0),
     m_jobsProgress(0),
+    m_jobsPercentage(0),
     m_jobsAnimationProgress(0),
     m_dragTimer(0),
     m_highlightTimer(0),
+    m_labelTimer(0),
     m_menuVisible(false),
     m_isDemandingAttention(false),
     m_jobsRunning(false),
+    m_jobsPending(false),
+    m_jobsAnimating(false),
+    m_animationRepeat(false),
     m_isVisible(true),
     m_isPressed(false)
 {
@@ -87,10 +116,7 @@ Icon::Icon(int id, Task *task, Launcher *launcher, Job *job, Applet *applet) : Q
     setLayout(m_layout);
 
     m_visualizationPixmap = NULL;
-
-    m_animationTimeLine->setFrameRange(0, 100);
-    m_animationTimeLine->setUpdateInterval(50);
-    m_animationTimeLine->setCurveShape(QTimeLine::LinearCurve);
+    m_activeVisualizationPixmap = NULL;
 
     m_layout->setOrientation((m_applet->location() == Plasma::LeftEdge || m_applet->location() == Plasma::RightEdge)?Qt::Vertical:Qt::Horizontal);
     m_layout->addStretch();
@@ -111,8 +137,6 @@ Icon::Icon(int id, Task *task, Launcher *launcher, Job *job, Applet *applet) : Q
 
     connect(m_applet, SIGNAL(sizeChanged(qreal)), this, SLOT(setSize(qreal)));
     connect(m_applet, SIGNAL(sizeChanged(qreal)), this, SIGNAL(sizeChanged(qreal)));
-    connect(m_animationTimeLine, SIGNAL(finished()), this, SLOT(stopAnimation()));
-    connect(m_animationTimeLine, SIGNAL(frameChanged(int)), this, SLOT(progressAnimation(int)));
 }
 
 void Icon::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
@@ -144,6 +168,7 @@ void Icon::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWid
     qreal size = 0;
     qreal width = 0;
     qreal height = 0;
+    qreal glow = 0;
     const bool showLabel = (m_applet->titleLabelMode() != NoLabel && !title().isEmpty() && (m_applet->titleLabelMode() == AlwaysShowLabel || (m_task && m_task->isActive() && m_applet->titleLabelMode() == ActiveIconLabel) || (isUnderMouse() && m_applet->titleLabelMode() == MouseOverLabel)));
 
     switch (m_applet->location())
@@ -178,10 +203,19 @@ void Icon::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWid
         m_visualizationPixmap = icon().pixmap(m_size);
     }
 
+    const FrameKey key = frameKey(visualizationSize, showLabel);
+
+    if (!m_framePixmap.isNull() && key == m_frameKey)
+    {
+        painter->drawPixmap(0, 0, m_framePixmap);
+
+        return;
+    }
+
     painter->setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing | QPainter::TextAntialiasing);
 
-    QPixmap target = QPixmap(ceil(boundingRect().width()), ceil(boundingRect().height()));
-    target.fill(Qt::transparent);
+    QImage target(ceil(boundingRect().width()), ceil(boundingRect().height()), QImage::Format_ARGB32_Premultiplied);
+    target.fill(0);
 
     QPainter targetPainter(&target);
     targetPainter.setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing | QPainter::TextAntialiasing);
@@ -265,11 +299,13 @@ void Icon::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWid
 
                 break;
             case GlowAnimation:
-                changeGlow(true, m_animationProgress);
+                glow = m_animationProgress;
+
+                pixmapPainter.drawPixmap(QRectF(0, 0, m_size, m_size), m_visualizationPixmap, QRectF(0, 0, m_size, m_size));
 
                 break;
             case SpotlightAnimation:
-                spotlightPixmap = m_applet->theme()->pixmap("spotlight").scaled(m_size, m_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+                spotlightPixmap = m_applet->themePixmap("spotlight", QSize(m_size, m_size));
 
                 pixmapPainter.setOpacity((cos(2 * PI * m_animationProgress) + 1) / 4);
                 pixmapPainter.drawPixmap(0, 0, spotlightPixmap);
@@ -292,12 +328,12 @@ void Icon::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWid
 
     if (hasFocus())
     {
-        targetPainter.drawPixmap(xOffset, yOffset, m_applet->theme()->pixmap("focus").scaled(visualizationSize, visualizationSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+        targetPainter.drawPixmap(xOffset, yOffset, m_applet->themePixmap("focus", QSize(visualizationSize, visualizationSize)));
     }
 
     if (m_task && m_task->isActive() && m_applet->activeIconIndication() == GlowIndication && m_applet->moveAnimation() != GlowAnimation)
     {
-        changeGlow(true, 1);
+        glow = 1;
 
         visualizationSize *= 0.8;
         xOffset += (visualizationSize * 0.15);
@@ -309,23 +345,23 @@ void Icon::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWid
         case ZoomAnimation:
             if (isUnderMouse() || hasFocus())
             {
-                visualizationPixmap = KIconLoader::global()->iconEffect()->apply(visualizationPixmap, KIconLoader::Desktop, KIconLoader::ActiveState);
+                visualizationPixmap = activeVisualizationPixmap(visualizationPixmap);
             }
 
             break;
         case GlowAnimation:
-            changeGlow(true, m_factor);
+            glow = m_factor;
 
             if (isUnderMouse() || hasFocus())
             {
-                visualizationPixmap = KIconLoader::global()->iconEffect()->apply(visualizationPixmap, KIconLoader::Desktop, KIconLoader::ActiveState);
+                visualizationPixmap = activeVisualizationPixmap(visualizationPixmap);
             }
 
             break;
         case SpotlightAnimation:
             if (m_factor > 0)
             {
-                spotlightPixmap = m_applet->theme()->pixmap("spotlight").scaled(visualizationSize, visualizationSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+                spotlightPixmap = m_applet->themePixmap("spotlight", QSize(visualizationSize, visualizationSize));
 
                 targetPainter.setOpacity(m_factor);
                 targetPainter.drawPixmap(0, 0, spotlightPixmap);
@@ -343,138 +379,64 @@ void Icon::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWid
 
     if (m_task && m_task->isActive() && m_applet->activeIconIndication() == FadeIndication)
     {
-        visualizationPixmap = KIconLoader::global()->iconEffect()->apply(visualizationPixmap, KIconLoader::Desktop, KIconLoader::ActiveState);
+        visualizationPixmap = activeVisualizationPixmap(visualizationPixmap);
     }
 
-    targetPainter.drawPixmap(QRectF(xOffset, yOffset, visualizationSize, visualizationSize), visualizationPixmap, visualizationPixmap.rect());
-
-    if (m_jobsRunning && m_jobs.count())
+    if (glow > 0)
     {
-        qreal rotation = 0;
-
-        QPixmap progressPixmap = m_applet->theme()->pixmap("progress").scaled((visualizationSize * 0.8), (visualizationSize * 0.8), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        const QPixmap haloPixmap = glowPixmap(visualizationSize);
+        const qreal glowSize = (haloPixmap.width() * (0.75 + (glow * 0.25)));
 
         targetPainter.save();
-        targetPainter.translate(QPointF((xOffset + (visualizationSize * 0.5)), (yOffset + (visualizationSize * 0.5))));
+        targetPainter.setOpacity(targetPainter.opacity() * qMin(glow, qreal(1)));
+        targetPainter.drawPixmap(QRectF((xOffset + ((visualizationSize - glowSize) / 2)), (yOffset + ((visualizationSize - glowSize) / 2)), glowSize, glowSize), haloPixmap, haloPixmap.rect());
+        targetPainter.restore();
+    }
 
-        if (m_jobsProgress < 100)
-        {
-            rotation = (m_jobsProgress?(3.6 * m_jobsProgress):m_jobsAnimationProgress);
+    targetPainter.drawPixmap(QRectF(xOffset, yOffset, visualizationSize, visualizationSize), visualizationPixmap, visualizationPixmap.rect());
 
-            targetPainter.rotate(rotation);
-        }
+    if (m_jobsRunning && m_jobs.count())
+    {
+        const int frameSize = qMin(96, qRound(m_size * 0.8));
+        const QPixmap progressPixmap = m_applet->progressFrames(QSize(frameSize, frameSize), PROGRESS_STEPS);
 
-        targetPainter.drawPixmap(QRectF(-(visualizationSize * 0.4), -(visualizationSize * 0.4), progressPixmap.width(), progressPixmap.width()), progressPixmap, progressPixmap.rect());
+        m_progressRect = QRectF((xOffset + (visualizationSize * 0.1)), (yOffset + (visualizationSize * 0.1)), (visualizationSize * 0.8), (visualizationSize * 0.8));
 
-        targetPainter.restore();
+        targetPainter.drawPixmap(m_progressRect, progressPixmap, QRectF((progressStep() * frameSize), 0, frameSize, frameSize));
+    }
+    else
+    {
+        m_progressRect = QRectF();
     }
 
     if (showLabel)
     {
-        const qreal labelSize = ((m_applet->location() == Plasma::LeftEdge || m_applet->location() == Plasma::RightEdge)?this->size().width():this->size().height());
-        const qreal maximumWidth = (target.width() * 0.95);
-        QFont font = targetPainter.font();
-        font.setPixelSize(labelSize * 0.15);
-
-        targetPainter.setFont(font);
-
-        const qreal textLength = (targetPainter.fontMetrics().width(title()) + (3 * targetPainter.fontMetrics().width(' ')));
-        const qreal textFieldWidth = ((textLength > maximumWidth)?maximumWidth:textLength);
-        const QRectF textField = QRectF(QPointF(((target.width() - textFieldWidth) / 2), (target.height() * 0.52)), QSizeF(textFieldWidth, (labelSize * 0.17)));
-        QPainterPath textFieldPath;
-        textFieldPath.addRoundedRect(textField, 3, 3);
+        const QPixmap label = labelPixmap(((m_applet->location() == Plasma::LeftEdge || m_applet->location() == Plasma::RightEdge)?this->size().width():this->size().height()), (target.width() * 0.95));
 
-        targetPainter.setOpacity(0.75);
-        targetPainter.fillPath(textFieldPath, QBrush(Plasma::Theme::defaultTheme()->color(Plasma::Theme::BackgroundColor)));
-        targetPainter.setPen(QPen(Plasma::Theme::defaultTheme()->color(Plasma::Theme::BackgroundColor).darker()));
-        targetPainter.drawRoundedRect(textField, 3, 3);
-        targetPainter.setPen(QPen(Plasma::Theme::defaultTheme()->color(Plasma::Theme::TextColor)));
         targetPainter.setOpacity(1);
-        targetPainter.drawText(textField, ((textLength > textFieldWidth)?((QApplication::layoutDirection() == Qt::LeftToRight)?Qt::AlignLeft:Qt::AlignRight):Qt::AlignCenter), ((textLength > textFieldWidth)?(' ' + title()):title()));
-
-        if (textLength > textFieldWidth)
-        {
-            QLinearGradient alphaGradient(0, 0, 1, 0);
-            alphaGradient.setCoordinateMode(QGradient::ObjectBoundingMode);
-
-            if (QApplication::layoutDirection() == Qt::LeftToRight)
-            {
-                alphaGradient.setColorAt(0, QColor(0, 0, 0, 255));
-                alphaGradient.setColorAt(0.8, QColor(0, 0, 0, 255));
-                alphaGradient.setColorAt(1, QColor(0, 0, 0, 25));
-            }
-            else
-            {
-                alphaGradient.setColorAt(0, QColor(0, 0, 0, 25));
-                alphaGradient.setColorAt(0.2, QColor(0, 0, 0, 255));
-                alphaGradient.setColorAt(1, QColor(0, 0, 0, 255));
-            }
-
-            targetPainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-            targetPainter.fillPath(textFieldPath, alphaGradient);
-            targetPainter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-        }
+        targetPainter.drawPixmap(QPointF(((target.width() - label.width()) / 2.0), ((target.height() * 0.52) - 1)), label);
     }
 
+    targetPainter.end();
+
     if (m_applet->paintReflections())
     {
-        QPointF reflectionPoint;
-        QPixmap reflectionPixmap;
-        QLinearGradient reflectionGradient;
-
-        switch (m_applet->location())
-        {
-            case Plasma::LeftEdge:
-                reflectionPoint = QPointF(0, 0);
-
-                reflectionPixmap = target.copy((target.width() * 0.2), 0, (target.width() * 0.2), target.height());
-                reflectionPixmap = reflectionPixmap.transformed(QTransform(-1, 0, 0, 0, 1, 0, 0, 0, 1), Qt::SmoothTransformation);
-
-                reflectionGradient = QLinearGradient(QPointF(reflectionPixmap.width(), 0), QPointF(0, 0));
-
-                break;
-            case Plasma::RightEdge:
-                reflectionPoint = QPointF((target.width() * 0.7), 0);
-
-                reflectionPixmap = target.copy((target.width() * 0.5), 0, (target.width() * 0.2), target.height());
-                reflectionPixmap = reflectionPixmap.transformed(QTransform(-1, 0, 0, 0, 1, 0, 0, 0, 1), Qt::SmoothTransformation);
-
-                reflectionGradient = QLinearGradient(QPointF(0, 0), QPointF(reflectionPixmap.width(), 0));
-
-                break;
-            case Plasma::TopEdge:
-                reflectionPoint = QPointF(0, 0);
-
-                reflectionPixmap = target.copy(0, (m_size / 4), target.width(), (target.height() * 0.2));
-                reflectionPixmap = reflectionPixmap.transformed(QTransform(1, 0, 0, 0, -1, 0, 0, 0, 1), Qt::SmoothTransformation);
-
-                reflectionGradient = QLinearGradient(QPointF(0, reflectionPixmap.height()), QPointF(0, 0));
-
-                break;
-            default:
-                reflectionPoint = QPointF(0, (target.height() * 0.7));
-
-                reflectionPixmap = target.copy(0, (target.height() * 0.5), target.width(), (target.height() * 0.2));
-                reflectionPixmap = reflectionPixmap.transformed(QTransform(1, 0, 0, 0, -1, 0, 0, 0, 1), Qt::SmoothTransformation);
-
-                reflectionGradient = QLinearGradient(QPointF(0, 0), QPointF(0, reflectionPixmap.height()));
-
-                break;
-        }
+        Reflection::self()->paint(&target, m_applet->location(), m_size);
+    }
 
-        reflectionGradient.setColorAt(0, QColor(0, 0, 0, 200));
-        reflectionGradient.setColorAt(0.6, QColor(0, 0, 0, 70));
-        reflectionGradient.setColorAt(0.9, Qt::transparent);
+    const QPixmap frame = QPixmap::fromImage(target);
 
-        QPainter reflectionPainter(&reflectionPixmap);
-        reflectionPainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-        reflectionPainter.fillRect(0, 0, reflectionPixmap.width(), reflectionPixmap.height(), reflectionGradient);
-        reflectionPainter.end();
+    painter->drawPixmap(0, 0, frame);
 
-        targetPainter.drawPixmap(reflectionPoint, reflectionPixmap);
+    if (m_applet->reserveFrameCache(this, (target.width() * target.height() * 4)))
+    {
+        m_framePixmap = frame;
+        m_frameKey = key;
+    }
+    else
+    {
+        m_framePixmap = QPixmap();
     }
-
-    painter->drawPixmap(0, 0, target);
 }
 
 void Icon::focusInEvent(QFocusEvent *event)
@@ -703,7 +665,14 @@ void Icon::timerEvent(QTimerEvent *event)
 {
     const ItemType type = itemType();
 
-    if (event->timerId() == m_dragTimer && isUnderMouse())
+    if (event->timerId() == m_labelTimer)
+    {
+        m_labelTimer = 0;
+        m_labelTitle = title();
+
+        update();
+    }
+    else if (event->timerId() == m_dragTimer && isUnderMouse())
     {
         if (type == TaskType)
         {
@@ -736,6 +705,7 @@ void Icon::show()
     emit visibilityChanged(true);
 
     m_visualizationPixmap = NULL;
+    m_activeVisualizationPixmap = NULL;
 
     update();
 }
@@ -781,7 +751,10 @@ void Icon::updateSize()
 {
     if (!m_isVisible || !m_applet)
     {
-        setPreferredSize(0, 0);
+        if (!m_applet || !m_applet->deferPreferredSize(this, QSizeF(0, 0)))
+        {
+            setPreferredSize(0, 0);
+        }
 
         return;
     }
@@ -789,14 +762,11 @@ void Icon::updateSize()
     const qreal factor = ((m_applet->moveAnimation() == ZoomAnimation)?m_factor:((m_applet->moveAnimation() == JumpAnimation)?m_applet->initialFactor():1));
     const qreal width = (m_size * (factor + 0.1));
     const qreal height = (m_size * 1.4);
+    const QSizeF size = ((m_applet->location() == Plasma::LeftEdge || m_applet->location() == Plasma::RightEdge)?QSizeF(height, width):QSizeF(width, height));
 
-    if (m_applet->location() == Plasma::LeftEdge || m_applet->location() == Plasma::RightEdge)
-    {
-        setPreferredSize(height, width);
-    }
-    else
+    if (!m_applet->deferPreferredSize(this, size))
     {
-        setPreferredSize(width, height);
+        setPreferredSize(size);
     }
 }
 
@@ -807,6 +777,11 @@ void Icon::updateIcon()
 
 void Icon::setFactor(qreal factor)
 {
+    if (m_applet->moveAnimation() == ZoomAnimation && m_applet->activeIconIndication() == ZoomIndication && m_task && m_task->isActive())
+    {
+        factor = 1;
+    }
+
     if (factor == m_factor)
     {
         return;
@@ -816,11 +791,6 @@ void Icon::setFactor(qreal factor)
 
     if (m_applet->moveAnimation() == ZoomAnimation)
     {
-        if (m_applet->activeIconIndication() == ZoomIndication && m_task && m_task->isActive())
-        {
-            m_factor = 1;
-        }
-
         updateSize();
     }
 
@@ -873,6 +843,7 @@ void Icon::setSize(qreal size)
     updateSize();
 
     m_visualizationPixmap = NULL;
+    m_activeVisualizationPixmap = NULL;
 
     update();
 }
@@ -897,17 +868,18 @@ void Icon::validate()
 void Icon::startAnimation(AnimationType animationType, int duration, bool repeat)
 {
     m_animationType = animationType;
+    m_animationDuration = qMax(1, duration);
+    m_animationRepeat = repeat;
+    m_animationStart = m_applet->animationTime();
+    m_animationProgress = 0;
 
-    m_animationTimeLine->setDuration(duration);
-    m_animationTimeLine->setLoopCount(repeat?0:1);
-    m_animationTimeLine->stop();
-    m_animationTimeLine->start();
+    m_applet->registerAnimation(this);
+
+    update();
 }
 
 void Icon::stopAnimation()
 {
-    m_animationTimeLine->stop();
-
     setOpacity(1);
 
     m_animationProgress = -1;
@@ -917,33 +889,64 @@ void Icon::stopAnimation()
     update();
 }
 
-void Icon::progressAnimation(int progress)
+bool Icon::advanceAnimation(qint64 time)
 {
-    if (sender() == m_animationTimeLine)
+    bool animating = false;
+    bool changed = false;
+    bool progressChanged = false;
+
+    if (m_jobsPending)
     {
-        m_animationProgress = ((qreal) progress / 100);
+        applyJobChanges();
     }
-    else if (sender() == m_jobAnimationTimeLine)
+
+    if (m_animationProgress >= 0)
     {
-        m_jobsAnimationProgress = progress;
-    }
+        const qint64 elapsed = (time - m_animationStart);
 
-    update();
-}
+        if (!m_animationRepeat && elapsed >= m_animationDuration)
+        {
+            stopAnimation();
+        }
+        else
+        {
+            const qreal progress = ((qreal) (((elapsed % m_animationDuration) * 100) / m_animationDuration) / 100);
 
-void Icon::changeGlow(bool enabled, qreal radius)
-{
-    if (enabled && !m_glowEffect)
+            if (progress != m_animationProgress)
+            {
+                m_animationProgress = progress;
+
+                changed = true;
+            }
+
+            animating = true;
+        }
+    }
+
+    if (m_jobsAnimating)
     {
-        m_glowEffect = new QGraphicsDropShadowEffect(this);
-        m_glowEffect->setOffset(0);
+        const int progress = ((((time - m_jobsAnimationStart) % 5000) * PROGRESS_STEPS) / 5000);
+
+        if (progress != m_jobsAnimationProgress)
+        {
+            m_jobsAnimationProgress = progress;
+
+            progressChanged = !m_jobsProgress;
+        }
 
-        setGraphicsEffect(m_glowEffect);
+        animating = true;
+    }
+
+    if (changed)
+    {
+        update();
+    }
+    else if (progressChanged)
+    {
+        update((m_progressRect.isEmpty() || m_applet->paintReflections())?boundingRect():m_progressRect);
     }
 
-    m_glowEffect->setEnabled(enabled);
-    m_glowEffect->setBlurRadius(radius * 25);
-    m_glowEffect->setColor(Plasma::Theme::defaultTheme()->color(Plasma::Theme::HighlightColor));
+    return animating;
 }
 
 void Icon::publishGeometry(Task *task)
@@ -958,43 +961,46 @@ void Icon::publishGeometry(Task *task)
         return;
     }
 
-    QRect iconGeometry = shape().controlPointRect().toRect();
+    const QRect geometry = iconGeometry(m_applet->parentView());
 
-    if (scene() && iconGeometry.isValid())
+    if (task == m_task)
     {
-        QGraphicsView *parentView = NULL;
-        QGraphicsView *possibleParentView = NULL;
+        m_publishedGeometry = geometry;
+    }
 
-        foreach (QGraphicsView *view, scene()->views())
-        {
-            if (view->sceneRect().intersects(sceneBoundingRect()) || view->sceneRect().contains(scenePos()))
-            {
-                if (view->isActiveWindow())
-                {
-                    parentView = view;
+    task->publishIconGeometry(geometry);
+}
 
-                    break;
-                }
-                else
-                {
-                    possibleParentView = view;
-                }
-            }
-        }
+void Icon::updateIconGeometry(QGraphicsView *parentView)
+{
+    if (!m_task || !(m_task->taskType() == TaskType || m_task->taskType() == GroupType))
+    {
+        return;
+    }
 
-        if (!parentView)
-        {
-            parentView = possibleParentView;
-        }
+    const QRect geometry = iconGeometry(parentView);
 
-        if (parentView)
-        {
-            iconGeometry = parentView->mapFromScene(mapToScene(iconGeometry)).boundingRect().adjusted(0, 0, 1, 1);
-            iconGeometry.moveTopLeft(parentView->mapToGlobal(iconGeometry.topLeft()));
-        }
+    if (geometry == m_publishedGeometry)
+    {
+        return;
     }
 
-    task->publishIconGeometry(iconGeometry);
+    m_publishedGeometry = geometry;
+
+    m_task->publishIconGeometry(geometry);
+}
+
+QRect Icon::iconGeometry(QGraphicsView *parentView) const
+{
+    QRect geometry = shape().controlPointRect().toRect();
+
+    if (parentView && scene() && geometry.isValid())
+    {
+        geometry = parentView->mapFromScene(mapToScene(geometry)).boundingRect().adjusted(0, 0, 1, 1);
+        geometry.moveTopLeft(parentView->mapToGlobal(geometry.topLeft()));
+    }
+
+    return geometry;
 }
 
 void Icon::taskChanged(ItemChanges changes)
@@ -1017,6 +1023,8 @@ void Icon::taskChanged(ItemChanges changes)
             stopAnimation();
 
             setLauncher(m_applet->launcherForTask(m_task));
+
+            m_applet->scheduleGeometryUpdate(this);
         }
     }
 
@@ -1054,9 +1062,15 @@ void Icon::taskChanged(ItemChanges changes)
         updateToolTip();
     }
 
+    if (changes & TextChanged)
+    {
+        updateLabel();
+    }
+
     if (changes & IconChanged)
     {
         m_visualizationPixmap = NULL;
+        m_activeVisualizationPixmap = NULL;
     }
 
     update();
@@ -1069,9 +1083,15 @@ void Icon::launcherChanged(ItemChanges changes)
         return;
     }
 
+    if (changes & TextChanged)
+    {
+        updateLabel();
+    }
+
     if (changes & IconChanged)
     {
         m_visualizationPixmap = NULL;
+        m_activeVisualizationPixmap = NULL;
     }
 
     update();
@@ -1081,65 +1101,83 @@ void Icon::launcherChanged(ItemChanges changes)
 
 void Icon::jobChanged(ItemChanges changes)
 {
-    Q_UNUSED(changes)
+    m_jobChanges |= changes;
 
-    int amount = 0;
-    int percentage = 0;
+    if (!m_jobsPending)
+    {
+        m_jobsPending = true;
+
+        m_applet->registerAnimation(this);
+    }
+}
 
-    m_jobsRunning = false;
+void Icon::jobUpdated(ItemChanges changes)
+{
+    Job *job = qobject_cast<Job*>(sender());
 
-    if (m_jobs.count() > 0)
+    if (job)
     {
-        for (int i = 0; i < m_jobs.count(); ++i)
-        {
-            if (!m_jobs.at(i))
-            {
-                m_jobs.removeAt(i);
+        countJob(job);
+    }
 
-                --i;
+    jobChanged(changes);
+}
 
-                continue;
-            }
+void Icon::jobDestroyed(QObject *job)
+{
+    m_jobsPercentage -= m_runningJobs.take(job);
 
-            if (m_jobs.at(i)->state() != FinishedState && !m_jobs.at(i)->state() != ErrorState)
-            {
-                ++amount;
+    m_jobs.removeAll(QPointer<Job>());
 
-                m_jobsRunning = true;
+    jobChanged(StateChanged);
+}
 
-                percentage += ((m_jobs.at(i)->percentage() >= 0)?m_jobs.at(i)->percentage():0);
-            }
-        }
-    }
+void Icon::countJob(Job *job)
+{
+    m_jobsPercentage -= m_runningJobs.take(job);
 
-    if (percentage)
+    if (job->state() != FinishedState && job->state() != ErrorState)
     {
-        percentage /= amount;
+        const int percentage = qMax(0, job->percentage());
+
+        m_runningJobs[job] = percentage;
+
+        m_jobsPercentage += percentage;
     }
-    else if (m_jobsRunning)
-    {
-        if (!m_jobAnimationTimeLine)
-        {
-            m_jobAnimationTimeLine = new QTimeLine(5000, this);
-            m_jobAnimationTimeLine->setLoopCount(0);
-            m_jobAnimationTimeLine->setFrameRange(0, 359);
-            m_jobAnimationTimeLine->setCurveShape(QTimeLine::LinearCurve);
+}
 
-            connect(m_jobAnimationTimeLine, SIGNAL(frameChanged(int)), this, SLOT(progressAnimation(int)));
-        }
+void Icon::applyJobChanges()
+{
+    const ItemChanges changes = m_jobChanges;
 
-        if (m_jobAnimationTimeLine->state() != QTimeLine::Running)
-        {
-            m_jobAnimationTimeLine->start();
-        }
+    m_jobChanges = NoChanges;
+    m_jobsPending = false;
+
+    if (changes & TextChanged)
+    {
+        updateLabel();
     }
 
-    if (!m_jobsRunning && m_jobAnimationTimeLine && m_jobAnimationTimeLine->state() == QTimeLine::Running)
+    const int amount = m_runningJobs.count();
+    int percentage = 0;
+
+    m_jobsRunning = (amount > 0);
+
+    if (m_jobsRunning && m_jobsPercentage > 0)
     {
-        m_jobAnimationTimeLine->stop();
-        m_jobAnimationTimeLine->deleteLater();
-        m_jobAnimationTimeLine = NULL;
+        percentage = (m_jobsPercentage / amount);
+    }
+    else if (m_jobsRunning && !m_jobsAnimating)
+    {
+        m_jobsAnimating = true;
+        m_jobsAnimationStart = m_applet->animationTime();
+
+        m_applet->registerAnimation(this);
+    }
 
+    if ((!m_jobsRunning || percentage > 0) && m_jobsAnimating)
+    {
+        m_jobsAnimating = false;
         m_jobsAnimationProgress = 0;
     }
 
@@ -1169,12 +1207,13 @@ void Icon::jobDemandsAttention()
 
 void Icon::setLauncher(Launcher *launcher)
 {
-    if (m_launcher && !launcher)
+    if (m_launcher && m_launcher != launcher)
     {
         m_launcher->removeItem(this);
     }
 
     m_launcher = launcher;
+    m_labelTitle = QString();
 
     if (!m_launcher)
     {
@@ -1211,17 +1250,31 @@ void Icon::addJob(Job *job)
 
     m_jobs.append(job);
 
+    m_labelTitle = QString();
+
+    countJob(job);
+
     jobChanged(StateChanged);
 
-    connect(job, SIGNAL(changed(ItemChanges)), this, SLOT(jobChanged(ItemChanges)));
-    connect(job, SIGNAL(m_animationTimeLine()), this, SLOT(jobDemandsAttention()));
-    connect(job, SIGNAL(close(FancyTasksJob*)), this, SLOT(removeJob(FancyTasksJob*)));
+    connect(job, SIGNAL(changed(ItemChanges)), this, SLOT(jobUpdated(ItemChanges)));
+    connect(job, SIGNAL(demandsAttention()), this, SLOT(jobDemandsAttention()));
+    connect(job, SIGNAL(close(Job*)), this, SLOT(removeJob(Job*)));
+    connect(job, SIGNAL(destroyed(QObject*)), this, SLOT(jobDestroyed(QObject*)));
 }
 
 void Icon::removeJob(Job *job)
 {
+    if (job)
+    {
+        disconnect(job, 0, this, 0);
+    }
+
+    m_jobsPercentage -= m_runningJobs.take(job);
+
     m_jobs.removeAll(job);
 
+    m_labelTitle = QString();
+
     if (itemType() == OtherType)
     {
         deleteLater();
@@ -1234,6 +1287,17 @@ void Icon::removeJob(Job *job)
 
 void Icon::addWindow(WId window)
 {
+    if (!m_windows.contains(window))
+    {
+        const quint64 fingerprint = m_windowsFingerprint;
+
+        m_windows.insert(window);
+
+        m_windowsFingerprint ^= windowHash(window);
+
+        m_applet->indexWindows(this, fingerprint);
+    }
+
     if (m_windowLights.contains(window) || !KWindowSystem::hasWId(window) || m_windowLights.count() > 3)
     {
         return;
@@ -1259,6 +1323,15 @@ void Icon::addWindow(WId window)
 
 void Icon::removeWindow(WId window)
 {
+    if (m_windows.remove(window))
+    {
+        const quint64 fingerprint = m_windowsFingerprint;
+
+        m_windowsFingerprint ^= windowHash(window);
+
+        m_applet->indexWindows(this, fingerprint);
+    }
+
     if (m_windowLights.contains(window))
     {
         if (m_windowLights[window])
@@ -1280,8 +1353,26 @@ void Icon::removeWindow(WId window)
     }
 }
 
+void Icon::clearWindows()
+{
+    if (m_windows.isEmpty())
+    {
+        return;
+    }
+
+    const quint64 fingerprint = m_windowsFingerprint;
+
+    m_windows.clear();
+
+    m_windowsFingerprint = 0;
+
+    m_applet->indexWindows(this, fingerprint);
+}
+
 void Icon::setTask(Task *task)
 {
+    m_labelTitle = QString();
+
     if (!task)
     {
         if (m_task)
@@ -1295,6 +1386,8 @@ void Icon::setTask(Task *task)
 
             m_windowLights.clear();
 
+            clearWindows();
+
             updateToolTip();
 
             update();
@@ -1307,8 +1400,6 @@ void Icon::setTask(Task *task)
         return;
     }
 
-    QTimer::singleShot(1000, this, SLOT(publishGeometry()));
-
     if (task->taskType() == StartupType)
     {
         if (m_applet->startupAnimation() != NoAnimation)
@@ -1325,6 +1416,9 @@ void Icon::setTask(Task *task)
     }
 
     m_task = task;
+    m_publishedGeometry = QRect();
+
+    clearWindows();
 
     if (m_launcher)
     {
@@ -1646,6 +1740,160 @@ void Icon::updateToolTip()
     Plasma::ToolTipManager::self()->setContent(this, data);
 }
 
+void Icon::updateLabel()
+{
+    if (!m_labelTitle.isNull() && !m_labelTimer)
+    {
+        m_labelTimer = startTimer(500);
+    }
+}
+
+QPixmap Icon::labelPixmap(qreal labelSize, qreal maximumWidth)
+{
+    if (m_labelTitle.isNull())
+    {
+        m_labelTitle = title();
+    }
+
+    const QColor backgroundColor = Plasma::Theme::defaultTheme()->color(Plasma::Theme::BackgroundColor);
+    const QColor textColor = Plasma::Theme::defaultTheme()->color(Plasma::Theme::TextColor);
+    const QString key = QString("%1 %2 %3 %4 %5 %6 %7").arg(qRound(labelSize * 100)).arg(qRound(maximumWidth * 100)).arg(static_cast<int>(QApplication::layoutDirection())).arg(backgroundColor.rgba()).arg(textColor.rgba()).arg(m_applet->cacheRevision()).arg(m_labelTitle);
+
+    if (!m_labelPixmap.isNull() && key == m_labelKey)
+    {
+        return m_labelPixmap;
+    }
+
+    QFont font = QApplication::font();
+    font.setPixelSize(labelSize * 0.15);
+
+    const QFontMetrics fontMetrics(font);
+    const qreal textLength = (fontMetrics.width(m_labelTitle) + (3 * fontMetrics.width(' ')));
+    const qreal textFieldWidth = ((textLength > maximumWidth)?maximumWidth:textLength);
+    const QRectF textField = QRectF(1, 1, textFieldWidth, (labelSize * 0.17));
+    QPainterPath textFieldPath;
+    textFieldPath.addRoundedRect(textField, 3, 3);
+
+    m_labelPixmap = QPixmap((ceil(textFieldWidth) + 2), (ceil(labelSize * 0.17) + 2));
+    m_labelPixmap.fill(Qt::transparent);
+    m_labelKey = key;
+
+    QPainter labelPainter(&m_labelPixmap);
+    labelPainter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+    labelPainter.setFont(font);
+    labelPainter.setOpacity(0.75);
+    labelPainter.fillPath(textFieldPath, QBrush(backgroundColor));
+    labelPainter.setPen(QPen(backgroundColor.darker()));
+    labelPainter.drawRoundedRect(textField, 3, 3);
+    labelPainter.setPen(QPen(textColor));
+    labelPainter.setOpacity(1);
+    labelPainter.drawText(textField, ((textLength > textFieldWidth)?((QApplication::layoutDirection() == Qt::LeftToRight)?Qt::AlignLeft:Qt::AlignRight):Qt::AlignCenter), ((textLength > textFieldWidth)?(' ' + m_labelTitle):m_labelTitle));
+
+    if (textLength > textFieldWidth)
+    {
+        QLinearGradient alphaGradient(0, 0, 1, 0);
+        alphaGradient.setCoordinateMode(QGradient::ObjectBoundingMode);
+
+        if (QApplication::layoutDirection() == Qt::LeftToRight)
+        {
+            alphaGradient.setColorAt(0, QColor(0, 0, 0, 255));
+            alphaGradient.setColorAt(0.8, QColor(0, 0, 0, 255));
+            alphaGradient.setColorAt(1, QColor(0, 0, 0, 25));
+        }
+        else
+        {
+            alphaGradient.setColorAt(0, QColor(0, 0, 0, 25));
+            alphaGradient.setColorAt(0.2, QColor(0, 0, 0, 255));
+            alphaGradient.setColorAt(1, QColor(0, 0, 0, 255));
+        }
+
+        labelPainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+        labelPainter.fillPath(textFieldPath, alphaGradient);
+    }
+
+    labelPainter.end();
+
+    return m_labelPixmap;
+}
+
+QPixmap Icon::glowPixmap(qreal size)
+{
+    const QColor color = Plasma::Theme::defaultTheme()->color(Plasma::Theme::HighlightColor);
+    const QString key = QString("%1 %2 %3").arg(m_visualizationPixmap.cacheKey()).arg(qRound(size * 100)).arg(color.rgba());
+
+    if (!m_glowPixmap.isNull() && key == m_glowKey)
+    {
+        return m_glowPixmap;
+    }
+
+    const int radius = 25;
+
+    QImage glowImage((ceil(size) + (2 * radius)), (ceil(size) + (2 * radius)), QImage::Format_ARGB32_Premultiplied);
+    glowImage.fill(0);
+
+    QPainter glowPainter(&glowImage);
+    glowPainter.setRenderHints(QPainter::SmoothPixmapTransform | QPainter::Antialiasing);
+    glowPainter.drawPixmap(QRectF(radius, radius, size, size), m_visualizationPixmap, m_visualizationPixmap.rect());
+    glowPainter.end();
+
+    Plasma::PaintUtils::shadowBlur(glowImage, (radius / 2), color);
+
+    m_glowPixmap = QPixmap::fromImage(glowImage);
+    m_glowKey = key;
+
+    return m_glowPixmap;
+}
+
+QPixmap Icon::activeVisualizationPixmap(const QPixmap &pixmap)
+{
+    if (pixmap.cacheKey() != m_visualizationPixmap.cacheKey())
+    {
+        return KIconLoader::global()->iconEffect()->apply(pixmap, KIconLoader::Desktop, KIconLoader::ActiveState);
+    }
+
+    if (m_activeVisualizationPixmap.isNull())
+    {
+        m_activeVisualizationPixmap = KIconLoader::global()->iconEffect()->apply(m_visualizationPixmap, KIconLoader::Desktop, KIconLoader::ActiveState);
+    }
+
+    return m_activeVisualizationPixmap;
+}
+
+int Icon::progressStep() const
+{
+    if (m_jobsProgress >= 100)
+    {
+        return 0;
+    }
+
+    return (m_jobsProgress?((m_jobsProgress * PROGRESS_STEPS) / 100):m_jobsAnimationProgress);
+}
+
+Icon::FrameKey Icon::frameKey(qreal visualizationSize, bool showLabel) const
+{
+    FrameKey key;
+    key.visualization = m_visualizationPixmap.cacheKey();
+    key.size = m_size;
+    key.visualizationSize = visualizationSize;
+    key.width = ceil(boundingRect().width());
+    key.height = ceil(boundingRect().height());
+    key.factor = qRound(m_factor * 100);
+    key.animationType = static_cast<int>(m_animationType);
+    key.animationProgress = qRound(m_animationProgress * 100);
+    key.states = ((hasFocus()?1:0) | (isUnderMouse()?2:0) | (m_isPressed?4:0) | ((m_task && m_task->isActive())?8:0) | (m_jobsRunning?16:0) | (showLabel?32:0));
+    key.jobs = m_jobs.count();
+    key.progress = progressStep();
+    key.location = static_cast<int>(m_applet->location());
+    key.revision = m_applet->cacheRevision();
+
+    if (showLabel)
+    {
+        key.label = m_labelTitle;
+    }
+
+    return key;
+}
+
 ItemType Icon::itemType() const
 {
     if (m_task)
@@ -1690,6 +1938,11 @@ QList<QPointer<Job> > Icon::jobs()
     return m_jobs;
 }
 
+QSet<WId> Icon::windows() const
+{
+    return m_windows;
+}
+
 QString Icon::title() const
 {
     switch (itemType())
@@ -1814,11 +2067,35 @@ qreal Icon::factor() const
     return m_factor;
 }
 
+qreal Icon::restingFactor() const
+{
+    if (m_applet->moveAnimation() == ZoomAnimation && m_applet->activeIconIndication() == ZoomIndication && m_task && m_task->isActive())
+    {
+        return 1;
+    }
+
+    return m_applet->initialFactor();
+}
+
+quint64 Icon::windowsFingerprint() const
+{
+    return m_windowsFingerprint;
+}
+
 int Icon::id() const
 {
     return m_id;
 }
 
+quint64 Icon::windowHash(WId window)
+{
+    quint64 hash = (quint64(window) + Q_UINT64_C(0x9e3779b97f4a7c15));
+    hash = ((hash ^ (hash >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9));
+    hash = ((hash ^ (hash >> 27)) * Q_UINT64_C(0x94d049bb133111eb));
+
+    return (hash ^ (hash >> 31));
+}
+
 bool Icon::isVisible() const
 {
     return m_isVisible;
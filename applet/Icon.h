@@ -23,16 +23,17 @@
 
 #include "Constants.h"
 
+#include <QtCore/QSet>
+#include <QtCore/QHash>
 #include <QtCore/QPointer>
-#include <QtCore/QTimeLine>
 #include <QtCore/QTimerEvent>
 #include <QtGui/QPixmap>
 #include <QtGui/QPainter>
 #include <QtGui/QKeyEvent>
 #include <QtGui/QFocusEvent>
+#include <QtGui/QGraphicsView>
 #include <QtGui/QGraphicsWidget>
 #include <QtGui/QGraphicsLinearLayout>
-#include <QtGui/QGraphicsDropShadowEffect>
 
 #include <KIcon>
 
@@ -56,14 +57,20 @@ class Icon : public QGraphicsWidget
         QPointer<Task> task();
         QPointer<Launcher> launcher();
         QList<QPointer<Job> > jobs();
+        QSet<WId> windows() const;
         QString title() const;
         QString description() const;
         QPainterPath shape() const;
         KIcon icon() const;
         qreal factor() const;
+        qreal restingFactor() const;
+        quint64 windowsFingerprint() const;
         int id() const;
         bool isVisible() const;
         bool isDemandingAttention() const;
+        bool advanceAnimation(qint64 time);
+        void updateIconGeometry(QGraphicsView *parentView);
+        static quint64 windowHash(WId window);
 
     public slots:
         void show();
@@ -84,6 +91,28 @@ class Icon : public QGraphicsWidget
         void performAction(IconAction action, Task *task = NULL);
 
     protected:
+        struct FrameKey
+        {
+            FrameKey();
+
+            bool operator==(const FrameKey &other) const;
+
+            QString label;
+            qint64 visualization;
+            qreal size;
+            qreal visualizationSize;
+            int width;
+            int height;
+            int factor;
+            int animationType;
+            int animationProgress;
+            int states;
+            int jobs;
+            int progress;
+            int location;
+            int revision;
+        };
+
         void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
         void focusInEvent(QFocusEvent *event);
         void focusOutEvent(QFocusEvent *event);
@@ -100,17 +129,27 @@ class Icon : public QGraphicsWidget
         void keyPressEvent(QKeyEvent *event);
         void contextMenuEvent(QGraphicsSceneContextMenuEvent *event);
         void timerEvent(QTimerEvent *event);
+        void updateLabel();
+        void clearWindows();
+        void countJob(Job *job);
+        void applyJobChanges();
+        QPixmap labelPixmap(qreal labelSize, qreal maximumWidth);
+        QPixmap activeVisualizationPixmap(const QPixmap &pixmap);
+        QPixmap glowPixmap(qreal size);
+        FrameKey frameKey(qreal visualizationSize, bool showLabel) const;
+        int progressStep() const;
+        QRect iconGeometry(QGraphicsView *parentView) const;
 
     protected slots:
         void validate();
         void startAnimation(AnimationType animationType, int duration, bool repeat);
         void stopAnimation();
-        void progressAnimation(int progress);
-        void changeGlow(bool enable, qreal radius);
         void publishGeometry(Task *task = NULL);
         void taskChanged(ItemChanges changes);
         void launcherChanged(ItemChanges changes);
         void jobChanged(ItemChanges changes);
+        void jobUpdated(ItemChanges changes);
+        void jobDestroyed(QObject *job);
         void jobDemandsAttention();
         void toolTipAboutToShow();
         void toolTipHidden();
@@ -120,25 +159,44 @@ class Icon : public QGraphicsWidget
         QPointer<Applet> m_applet;
         QPointer<Task> m_task;
         QPointer<Launcher> m_launcher;
-        QPointer<QGraphicsDropShadowEffect> m_glowEffect;
         QList<QPointer<Job> > m_jobs;
         QMap<WId, QPointer<Light> > m_windowLights;
+        QSet<WId> m_windows;
+        QHash<QObject*, int> m_runningJobs;
         QGraphicsLinearLayout *m_layout;
-        QTimeLine *m_animationTimeLine;
-        QTimeLine *m_jobAnimationTimeLine;
         QPixmap m_visualizationPixmap;
+        QPixmap m_activeVisualizationPixmap;
+        QPixmap m_labelPixmap;
+        QPixmap m_glowPixmap;
+        QPixmap m_framePixmap;
+        QString m_labelKey;
+        QString m_glowKey;
+        QString m_labelTitle;
+        QRect m_publishedGeometry;
+        QRectF m_progressRect;
+        FrameKey m_frameKey;
         AnimationType m_animationType;
+        ItemChanges m_jobChanges;
         qreal m_size;
         qreal m_factor;
         qreal m_animationProgress;
+        qint64 m_animationStart;
+        qint64 m_jobsAnimationStart;
+        quint64 m_windowsFingerprint;
         int m_id;
+        int m_animationDuration;
         int m_jobsProgress;
+        int m_jobsPercentage;
         int m_jobsAnimationProgress;
         int m_dragTimer;
         int m_highlightTimer;
+        int m_labelTimer;
         bool m_menuVisible;
         bool m_isDemandingAttention;
         bool m_jobsRunning;
+        bool m_jobsPending;
+        bool m_jobsAnimating;
+        bool m_animationRepeat;
         bool m_isVisible;
         bool m_isPressed;
 
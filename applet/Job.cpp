@@ -29,9 +29,13 @@ Job::Job(const QString &job, Applet *applet) : QObject(applet),
     m_job(job),
     m_state(UnknownState),
     m_percentage(-1),
-    m_closeOnFinish(false)
+    m_interval(250),
+    m_closeOnFinish(false),
+    m_reconnecting(false)
 {
-    m_applet->dataEngine("applicationjobs")->connectSource(m_job, this, 250, Plasma::NoAlignment);
+    m_progressTime.start();
+
+    m_applet->dataEngine("applicationjobs")->connectSource(m_job, this, m_interval, Plasma::NoAlignment);
 
     dataUpdated("", m_applet->dataEngine("applicationjobs")->query(m_job));
 }
@@ -40,15 +44,37 @@ void Job::dataUpdated(const QString &source, const Plasma::DataEngine::Data &dat
 {
     Q_UNUSED(source)
 
-    ItemChanges changes = TextChanged;
+    if (m_reconnecting)
+    {
+        return;
+    }
+
+    if (data == m_data)
+    {
+        if (m_state == RunningState && m_progressTime.elapsed() >= 2000)
+        {
+            setInterval(1000);
+        }
+
+        return;
+    }
+
+    m_data = data;
+
+    ItemChanges changes = NoChanges;
 
-    if (m_iconName.isEmpty())
+    if (m_iconName.isEmpty() && !data["appIconName"].toString().isEmpty())
     {
         m_iconName = data["appIconName"].toString();
 
         changes |= IconChanged;
     }
 
+    const QString previousTitle = m_title;
+    const QString previousDescription = m_description;
+    const QString previousInformation = m_information;
+    const int previousPercentage = m_percentage;
+
     m_title = data["infoMessage"].toString();
     m_application = data["appName"].toString();
     m_percentage = (data.contains("percentage")?data["percentage"].toInt():-1);
@@ -95,7 +121,12 @@ void Job::dataUpdated(const QString &source, const Plasma::DataEngine::Data &dat
     }
     else
     {
-        setFinished(true);
+        if (previousState != FinishedState && previousState != ErrorState)
+        {
+            emit demandsAttention();
+        }
+
+        finish();
     }
 
     m_description.clear();
@@ -113,21 +144,75 @@ void Job::dataUpdated(const QString &source, const Plasma::DataEngine::Data &dat
     m_description = m_description.left(m_description.size() - 4);
     m_information = QString("<b>%1</b> %2").arg(m_percentage?QString("%1 %2%").arg(m_title).arg(m_percentage):m_title).arg(description);
 
-    if (previousState != m_state)
+    if (m_title != previousTitle || m_description != previousDescription || m_information != previousInformation)
+    {
+        changes |= TextChanged;
+    }
+
+    if (previousState != m_state || previousPercentage != m_percentage)
     {
         changes |= StateChanged;
+
+        m_progressTime.restart();
     }
 
-    emit changed(changes);
+    updateInterval(previousPercentage);
+
+    if (changes != NoChanges)
+    {
+        emit changed(changes);
+    }
+}
+
+void Job::finish()
+{
+    m_title = i18n("%1 [Finished]", m_title);
+    m_information = QString("<b>%1</b>").arg(m_title);
+    m_state = FinishedState;
+}
+
+void Job::updateInterval(int previousPercentage)
+{
+    int interval = 250;
+
+    if (m_state == FinishedState || m_state == ErrorState || m_state == SuspendedState)
+    {
+        interval = 2000;
+    }
+    else if (m_percentage >= 0 && (m_percentage - previousPercentage) >= 2)
+    {
+        interval = 100;
+    }
+    else if (m_state == RunningState && m_progressTime.elapsed() >= 2000)
+    {
+        interval = 1000;
+    }
+
+    setInterval(interval);
+}
+
+void Job::setInterval(int interval)
+{
+    if (interval == m_interval)
+    {
+        return;
+    }
+
+    m_interval = interval;
+    m_reconnecting = true;
+
+    m_applet->dataEngine("applicationjobs")->connectSource(m_job, this, m_interval, Plasma::NoAlignment);
+
+    m_reconnecting = false;
 }
 
 void Job::setFinished(bool finished)
 {
     if (finished)
     {
-        m_title = i18n("%1 [Finished]", m_title);
-        m_information = QString("<b>%1</b>").arg(m_title);
-        m_state = FinishedState;
+        finish();
+
+        emit changed(TextChanged | StateChanged);
     }
 
     emit demandsAttention();
@@ -23,6 +23,8 @@
 
 #include "Constants.h"
 
+#include <QtCore/QElapsedTimer>
+
 #include <KIcon>
 #include <KMenu>
 
@@ -61,8 +63,15 @@ class Job : public QObject
         void close();
         void destroy();
 
+    protected:
+        void finish();
+        void updateInterval(int previousPercentage);
+        void setInterval(int interval);
+
     private:
         QPointer<Applet> m_applet;
+        Plasma::DataEngine::Data m_data;
+        QElapsedTimer m_progressTime;
         QString m_job;
         QString m_title;
         QString m_description;
@@ -71,9 +80,11 @@ class Job : public QObject
         QString m_iconName;
         JobState m_state;
         int m_percentage;
+        int m_interval;
         bool m_closeOnFinish;
         bool m_killable;
         bool m_suspendable;
+        bool m_reconnecting;
 
     signals:
         void changed(ItemChanges changes);
@@ -22,9 +22,11 @@
 #include "Applet.h"
 #include "LauncherProperties.h"
 #include "Icon.h"
+#include "ServiceIndex.h"
 
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QtConcurrentRun>
 
 #include <KRun>
 #include <KShell>
@@ -37,28 +39,33 @@
 namespace FancyTasks
 {
 
-Launcher::Launcher(const KUrl &url, Applet *parent) : QObject(parent),
+LauncherMetadata::LauncherMetadata() : isDesktopFile(false)
+{
+}
+
+Launcher::Launcher(const KUrl &url, Applet *parent, bool deferred) : QObject(parent),
     m_applet(parent),
     m_serviceGroup(NULL),
     m_mimeType(NULL),
     m_trashLister(NULL),
     m_trashProcess(NULL),
+    m_resolveWatcher(NULL),
     m_launcherUrl(url),
     m_isExcluded(false),
     m_isExecutable(false),
-    m_isMenu(false)
+    m_isMenu(false),
+    m_isResolving(false),
+    m_hasCustomRules(false)
 {
-    setUrl(url);
-
-    m_isExcluded = !m_isExecutable;
-
-    if (m_isExecutable && !m_executable.isEmpty())
+    if (deferred)
     {
-        const QString command = m_executable.split(QRegExp("(?!\\\\)\\s"), QString::SkipEmptyParts).first().split(QRegExp("(?!\\\\)\\/"), QString::SkipEmptyParts).last();
+        resolveUrl(url);
 
-        m_rules[TaskCommandRule] = LauncherRule(command, PartialMatch, false);
-        m_rules[WindowClassRule] = LauncherRule(command, PartialMatch, false);
+        return;
     }
+
+    setUrl(url);
+    setDefaultRules();
 }
 
 Launcher::~Launcher()
@@ -268,6 +275,111 @@ void Launcher::removeItem(QObject *object)
 }
 
 void Launcher::setUrl(const KUrl &url)
+{
+    m_isResolving = false;
+
+    applyMetadata(url, (isDesktopFile(url)?readDesktopFile(url):LauncherMetadata()));
+
+    if (!m_isMenu)
+    {
+        ItemChanges changes = TextChanged;
+        changes |= IconChanged;
+
+        emit changed(changes);
+    }
+
+    emit rulesChanged();
+}
+
+void Launcher::resolveUrl(const KUrl &url)
+{
+    m_targetUrl = m_launcherUrl = url;
+    m_mimeType = KMimeType::defaultMimeTypePtr();
+    m_title = (url.fileName().isEmpty()?url.pathOrUrl():url.fileName());
+    m_description = url.pathOrUrl();
+    m_icon = KIcon("application-x-executable");
+    m_isResolving = true;
+
+    if (!isDesktopFile(url))
+    {
+        QMetaObject::invokeMethod(this, "applyResolvedUrl", Qt::QueuedConnection);
+
+        return;
+    }
+
+    if (!m_resolveWatcher)
+    {
+        m_resolveWatcher = new QFutureWatcher<bool>(this);
+
+        connect(m_resolveWatcher, SIGNAL(finished()), this, SLOT(applyResolvedUrl()));
+    }
+
+    m_resolveWatcher->setFuture(QtConcurrent::run(&Launcher::prefetchFile, url.toLocalFile()));
+}
+
+void Launcher::applyResolvedUrl()
+{
+    if (m_isResolving)
+    {
+        m_isResolving = false;
+
+        applyMetadata(m_launcherUrl, (isDesktopFile(m_launcherUrl)?readDesktopFile(m_launcherUrl):LauncherMetadata()));
+
+        if (!m_hasCustomRules)
+        {
+            setDefaultRules();
+        }
+
+        ItemChanges changes = TextChanged;
+        changes |= IconChanged;
+
+        emit changed(changes);
+        emit rulesChanged();
+    }
+
+    emit resolved();
+}
+
+LauncherMetadata Launcher::readDesktopFile(const KUrl &url)
+{
+    const KDesktopFile desktopFile(url.toLocalFile());
+    const KConfigGroup config = desktopFile.desktopGroup();
+    LauncherMetadata metadata;
+    metadata.targetUrl = url;
+    metadata.executable = config.readPathEntry("Exec", QString());
+    metadata.title = (desktopFile.readName().isEmpty()?url.fileName():desktopFile.readName());
+    metadata.description = (desktopFile.readGenericName().isEmpty()?(desktopFile.readComment().isEmpty()?url.path():desktopFile.readComment()):desktopFile.readGenericName());
+    metadata.icon = (QFile::exists(url.toLocalFile())?desktopFile.readIcon():QString("dialog-error"));
+    metadata.isDesktopFile = true;
+
+    if (metadata.executable.isEmpty())
+    {
+        metadata.targetUrl = KUrl(desktopFile.readUrl().isEmpty()?desktopFile.readPath():desktopFile.readUrl());
+    }
+
+    return metadata;
+}
+
+bool Launcher::prefetchFile(const QString &path)
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    file.readAll();
+
+    return true;
+}
+
+bool Launcher::isDesktopFile(const KUrl &url)
+{
+    return (url.isLocalFile() && KDesktopFile::isDesktopFile(url.toLocalFile()));
+}
+
+void Launcher::applyMetadata(const KUrl &url, const LauncherMetadata &metadata)
 {
     m_targetUrl = m_launcherUrl = url;
     m_serviceGroup = NULL;
@@ -296,35 +408,17 @@ void Launcher::setUrl(const KUrl &url)
 
     m_mimeType = KMimeType::findByUrl(m_launcherUrl);
 
-    if (m_launcherUrl.isLocalFile() && KDesktopFile::isDesktopFile(m_launcherUrl.toLocalFile()))
+    if (metadata.isDesktopFile)
     {
-        const KDesktopFile desktopFile(m_launcherUrl.toLocalFile());
-        const KConfigGroup config = desktopFile.desktopGroup();
-
-        m_executable = config.readPathEntry("Exec", QString());
-        m_title = (desktopFile.readName().isEmpty()?m_launcherUrl.fileName():desktopFile.readName());
-        m_description = (desktopFile.readGenericName().isEmpty()?(desktopFile.readComment().isEmpty()?m_launcherUrl.path():desktopFile.readComment()):desktopFile.readGenericName());
-
-        if (QFile::exists(m_launcherUrl.pathOrUrl()))
-        {
-            m_icon = KIcon(desktopFile.readIcon());
-        }
-        else
-        {
-            m_icon = KIcon("dialog-error");
-        }
+        m_executable = metadata.executable;
+        m_title = metadata.title;
+        m_description = metadata.description;
+        m_icon = KIcon(metadata.icon);
 
         if (m_executable.isEmpty())
         {
-            QString filePath = desktopFile.readUrl();
-
-            if (filePath.isEmpty())
-            {
-                filePath = desktopFile.readPath();
-            }
-
-            m_targetUrl = KUrl(filePath);
-            m_mimeType = KMimeType::findByUrl(KUrl(m_targetUrl));
+            m_targetUrl = metadata.targetUrl;
+            m_mimeType = KMimeType::findByUrl(m_targetUrl);
         }
 
         if (!m_trashLister && m_targetUrl == KUrl("trash:/"))
@@ -366,22 +460,36 @@ void Launcher::setUrl(const KUrl &url)
         }
     }
 
-    m_isExecutable = (m_launcherUrl.isLocalFile() && (m_mimeType->is("application/x-executable") || m_mimeType->is("application/x-shellscript") || KDesktopFile::isDesktopFile(m_launcherUrl.toLocalFile())));
+    m_isExecutable = (m_launcherUrl.isLocalFile() && (m_mimeType->is("application/x-executable") || m_mimeType->is("application/x-shellscript") || metadata.isDesktopFile));
+}
 
-    ItemChanges changes = TextChanged;
-    changes |= IconChanged;
+void Launcher::setDefaultRules()
+{
+    m_isExcluded = !m_isExecutable;
 
-    emit changed(changes);
+    if (m_isExecutable && !m_executable.isEmpty())
+    {
+        const QString command = ServiceIndex::executableName(m_executable);
+
+        m_rules[TaskCommandRule] = LauncherRule(command, PartialMatch, false);
+        m_rules[WindowClassRule] = LauncherRule(command, PartialMatch, false);
+    }
 }
 
 void Launcher::setExcluded(bool excluded)
 {
     m_isExcluded = excluded;
+    m_hasCustomRules = true;
+
+    emit rulesChanged();
 }
 
 void Launcher::setRules(const QMap<ConnectionRule, LauncherRule> &rules)
 {
     m_rules = rules;
+    m_hasCustomRules = true;
+
+    emit rulesChanged();
 }
 
 void Launcher::setBrowseMenu()
@@ -624,6 +732,11 @@ QMap<ConnectionRule, LauncherRule> Launcher::rules() const
     return m_rules;
 }
 
+QList<QObject*> Launcher::items() const
+{
+    return m_items;
+}
+
 int Launcher::itemsAmount() const
 {
     return m_items.count();
@@ -644,4 +757,9 @@ bool Launcher::isMenu() const
     return m_isMenu;
 }
 
+bool Launcher::isResolving() const
+{
+    return m_isResolving;
+}
+
 }
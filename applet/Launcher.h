@@ -24,6 +24,7 @@
 #include "Constants.h"
 
 #include <QtCore/QPointer>
+#include <QtCore/QFutureWatcher>
 #include <QtGui/QGraphicsSceneDragDropEvent>
 
 #include <KUrl>
@@ -38,12 +39,24 @@ namespace FancyTasks
 
 class Applet;
 
+struct LauncherMetadata
+{
+    LauncherMetadata();
+
+    KUrl targetUrl;
+    QString title;
+    QString description;
+    QString executable;
+    QString icon;
+    bool isDesktopFile;
+};
+
 class Launcher : public QObject
 {
     Q_OBJECT
 
     public:
-        explicit Launcher(const KUrl &url, Applet *applet);
+        explicit Launcher(const KUrl &url, Applet *applet, bool deferred = false);
         ~Launcher();
 
         void dropUrls(const KUrl::List &urls, Qt::KeyboardModifiers modifiers);
@@ -58,10 +71,13 @@ class Launcher : public QObject
         QString description() const;
         QString executable() const;
         QMap<ConnectionRule, LauncherRule> rules() const;
+        QList<QObject*> items() const;
         int itemsAmount() const;
         bool isExcluded() const;
         bool isExecutable() const;
         bool isMenu() const;
+        bool isResolving() const;
+        static LauncherMetadata readDesktopFile(const KUrl &url);
 
     public slots:
         void setUrl(const KUrl &url);
@@ -77,12 +93,23 @@ class Launcher : public QObject
         void removeItem(QObject *object);
         void showPropertiesDialog();
 
+    protected:
+        void resolveUrl(const KUrl &url);
+        void applyMetadata(const KUrl &url, const LauncherMetadata &metadata);
+        void setDefaultRules();
+        static bool prefetchFile(const QString &path);
+        static bool isDesktopFile(const KUrl &url);
+
+    protected slots:
+        void applyResolvedUrl();
+
     private:
         QPointer<Applet> m_applet;
         KServiceGroup::Ptr m_serviceGroup;
         KMimeType::Ptr m_mimeType;
         KDirLister *m_trashLister;
         KProcess *m_trashProcess;
+        QFutureWatcher<bool> *m_resolveWatcher;
         KUrl m_launcherUrl;
         KUrl m_targetUrl;
         KIcon m_icon;
@@ -94,10 +121,14 @@ class Launcher : public QObject
         bool m_isExcluded;
         bool m_isExecutable;
         bool m_isMenu;
+        bool m_isResolving;
+        bool m_hasCustomRules;
 
     signals:
         void changed(ItemChanges changes);
         void launcherChanged(Launcher *launcher, KUrl oldUrl);
+        void rulesChanged();
+        void resolved();
         void hide();
         void show();
 };
@@ -21,6 +21,7 @@
 #include "LauncherProperties.h"
 #include "Launcher.h"
 #include "RuleDelegate.h"
+#include "CommandResolver.h"
 
 #include <QtGui/QMouseEvent>
 
@@ -29,9 +30,6 @@
 #include <KWindowInfo>
 #include <KWindowSystem>
 
-#include <ksysguard/process.h>
-#include <ksysguard/processes.h>
-
 #ifdef Q_WS_X11
 #include <QX11Info>
 
@@ -208,18 +206,7 @@ bool LauncherProperties::eventFilter(QObject *object, QEvent *event)
 
         if (window.valid())
         {
-            QString command;
-            const int pid = NETWinInfo(QX11Info::display(), target, root, NET::WMPid).pid();
-
-            KSysGuard::Processes processes;
-            processes.updateAllProcesses();
-
-            KSysGuard::Process *process = processes.getProcess(pid);
-
-            if (process)
-            {
-                command = process->command;
-            }
+            const QString command = CommandResolver::self()->command(NETWinInfo(QX11Info::display(), target, root, NET::WMPid).pid());
 
             QMap<ConnectionRule, LauncherRule> rules;
 
@@ -54,10 +54,7 @@ void Light::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWi
     Q_UNUSED(option)
     Q_UNUSED(widget)
 
-    const QPixmap pixmap = m_applet->lightPixmap();
-
-    painter->setRenderHints(QPainter::SmoothPixmapTransform);
-    painter->drawPixmap(boundingRect().toRect(), pixmap);
+    painter->drawPixmap(boundingRect().topLeft(), m_applet->themePixmap("task", boundingRect().size().toSize()));
 }
 
 void Light::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
@@ -20,11 +20,309 @@
 
 #include "Manager.h"
 
+#include <NETWinInfo>
+#include <KWindowInfo>
+#include <KWindowSystem>
+
+#ifdef Q_WS_X11
+#include <QX11Info>
+
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+#include <fixx11h.h>
+#endif
+
 namespace FancyTasks
 {
 
-Manager::Manager(QObject *parent) : QObject(parent)
+enum ManagerAtom
+{
+    Utf8StringAtom = 0,
+    NetStartupIdAtom,
+    AtomCount
+};
+
+static const char *atomNames[] = {"UTF8_STRING", "_NET_STARTUP_ID"};
+
+Manager::Manager(QObject *parent) : QObject(parent),
+    m_connection(NULL),
+    m_flushTimer(0)
+{
+#ifdef Q_WS_X11
+    if (QX11Info::display())
+    {
+        m_connection = XGetXCBConnection(QX11Info::display());
+
+        internAtoms();
+    }
+#endif
+
+    connect(KWindowSystem::self(), SIGNAL(windowRemoved(WId)), this, SLOT(removeWindow(WId)));
+    connect(KWindowSystem::self(), SIGNAL(windowChanged(WId, const unsigned long*)), this, SLOT(changeWindow(WId, const unsigned long*)));
+}
+
+void Manager::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_flushTimer)
+    {
+        flush();
+    }
+}
+
+void Manager::internAtoms()
+{
+#ifdef Q_WS_X11
+    QVector<xcb_intern_atom_cookie_t> cookies(AtomCount);
+
+    m_atoms.fill(XCB_ATOM_NONE, AtomCount);
+
+    for (int i = 0; i < AtomCount; ++i)
+    {
+        cookies[i] = xcb_intern_atom(m_connection, 0, qstrlen(atomNames[i]), atomNames[i]);
+    }
+
+    for (int i = 0; i < AtomCount; ++i)
+    {
+        xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(m_connection, cookies.at(i), NULL);
+
+        if (reply)
+        {
+            m_atoms[i] = reply->atom;
+
+            free(reply);
+        }
+    }
+#endif
+}
+
+void Manager::removeWindow(WId window)
 {
+    m_windows.remove(window);
+    m_pendingFetches.remove(window);
+}
+
+void Manager::changeWindow(WId window, const unsigned long *properties)
+{
+    if (!properties || !m_windows.contains(window))
+    {
+        return;
+    }
+
+    int changes = NoProperties;
+
+    if (properties[NETWinInfo::PROTOCOLS2] & NET::WM2WindowClass)
+    {
+        changes |= ClassProperty;
+    }
+
+    if (properties[NETWinInfo::PROTOCOLS2] & NET::WM2StartupId)
+    {
+        changes |= StartupIdProperty;
+    }
+
+    if (changes != NoProperties)
+    {
+        scheduleFetch(window, changes);
+    }
+}
+
+void Manager::scheduleFetch(WId window, int properties)
+{
+    m_pendingFetches[window] |= properties;
+
+    if (!m_flushTimer)
+    {
+        m_flushTimer = startTimer(20);
+    }
+}
+
+void Manager::flush()
+{
+    killTimer(m_flushTimer);
+
+    m_flushTimer = 0;
+
+    const QHash<WId, int> fetches = m_pendingFetches;
+    QHash<WId, WindowProperties> properties;
+    QHash<WId, WindowProperties>::const_iterator iterator;
+    QList<WId> changed;
+
+    m_pendingFetches.clear();
+
+    for (QHash<WId, int>::const_iterator fetchesIterator = fetches.constBegin(); fetchesIterator != fetches.constEnd(); ++fetchesIterator)
+    {
+        properties[fetchesIterator.key()] = m_windows.value(fetchesIterator.key());
+    }
+
+    fetchProperties(fetches, properties);
+
+    for (iterator = properties.constBegin(); iterator != properties.constEnd(); ++iterator)
+    {
+        const WId window = iterator.key();
+        const WindowProperties &current = iterator.value();
+
+        if (!m_windows.contains(window))
+        {
+            continue;
+        }
+
+        const WindowProperties &previous = m_windows[window];
+
+        if (previous.windowClass != current.windowClass || previous.windowName != current.windowName || previous.startupId != current.startupId)
+        {
+            m_windows[window] = current;
+
+            changed.append(window);
+        }
+    }
+
+    if (!changed.isEmpty())
+    {
+        emit windowsChanged(changed);
+    }
+}
+
+void Manager::fetchProperties(const QHash<WId, int> &fetches, QHash<WId, WindowProperties> &properties)
+{
+    if (fetches.isEmpty())
+    {
+        return;
+    }
+
+#ifdef Q_WS_X11
+    if (m_connection && m_atoms.count() == AtomCount)
+    {
+        QVector<QPair<QPair<WId, int>, xcb_get_property_cookie_t> > cookies;
+        QHash<WId, int>::const_iterator iterator;
+
+        for (iterator = fetches.constBegin(); iterator != fetches.constEnd(); ++iterator)
+        {
+            const xcb_window_t window = iterator.key();
+
+            if (iterator.value() & ClassProperty)
+            {
+                cookies.append(qMakePair(qMakePair(iterator.key(), int(ClassProperty)), xcb_get_property(m_connection, 0, window, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 0, 2048)));
+            }
+
+            if (iterator.value() & StartupIdProperty)
+            {
+                cookies.append(qMakePair(qMakePair(iterator.key(), int(StartupIdProperty)), xcb_get_property(m_connection, 0, window, m_atoms.at(NetStartupIdAtom), m_atoms.at(Utf8StringAtom), 0, 512)));
+            }
+        }
+
+        xcb_flush(m_connection);
+
+        for (int i = 0; i < cookies.count(); ++i)
+        {
+            const WId window = cookies.at(i).first.first;
+            const int property = cookies.at(i).first.second;
+            xcb_generic_error_t *error = NULL;
+            xcb_get_property_reply_t *reply = xcb_get_property_reply(m_connection, cookies.at(i).second, &error);
+            WindowProperties &windowProperties = properties[window];
+
+            if (error)
+            {
+                free(error);
+            }
+
+            if (!reply)
+            {
+                continue;
+            }
+
+            const char *value = static_cast<const char*>(xcb_get_property_value(reply));
+            const int length = xcb_get_property_value_length(reply);
+
+            switch (property)
+            {
+                case ClassProperty:
+                    {
+                        const QList<QByteArray> parts = QByteArray(value, length).split('\0');
+
+                        windowProperties.windowName = ((parts.count() > 0)?QString::fromLocal8Bit(parts.at(0)):QString());
+                        windowProperties.windowClass = ((parts.count() > 1)?QString::fromLocal8Bit(parts.at(1)):QString());
+                    }
+
+                    break;
+                case StartupIdProperty:
+                    windowProperties.startupId = QByteArray(value, length);
+
+                    break;
+                default:
+                    break;
+            }
+
+            free(reply);
+        }
+
+        return;
+    }
+#endif
+
+    QHash<WId, int>::const_iterator iterator;
+
+    for (iterator = fetches.constBegin(); iterator != fetches.constEnd(); ++iterator)
+    {
+        const KWindowInfo windowInfo = KWindowSystem::windowInfo(iterator.key(), 0, (NET::WM2WindowClass | NET::WM2StartupId));
+        WindowProperties &windowProperties = properties[iterator.key()];
+
+        windowProperties.windowClass = QString::fromLocal8Bit(windowInfo.windowClassClass());
+        windowProperties.windowName = QString::fromLocal8Bit(windowInfo.windowClassName());
+        windowProperties.startupId = windowInfo.startupId();
+    }
+}
+
+WindowProperties Manager::properties(WId window)
+{
+    if (!window)
+    {
+        return WindowProperties();
+    }
+
+    if (m_windows.contains(window) && !m_pendingFetches.contains(window))
+    {
+        return m_windows[window];
+    }
+
+    QHash<WId, int> fetches;
+    fetches[window] = AllProperties;
+
+    QHash<WId, WindowProperties> properties;
+
+    fetchProperties(fetches, properties);
+
+    m_pendingFetches.remove(window);
+
+    if (KWindowSystem::hasWId(window))
+    {
+        m_windows[window] = properties[window];
+    }
+
+    return properties[window];
+}
+
+void Manager::prefetch(const QList<WId> &windows)
+{
+    QHash<WId, int> fetches;
+    QHash<WId, WindowProperties> properties;
+    QHash<WId, WindowProperties>::const_iterator iterator;
+
+    for (int i = 0; i < windows.count(); ++i)
+    {
+        if (windows.at(i) && (!m_windows.contains(windows.at(i)) || m_pendingFetches.contains(windows.at(i))) && KWindowSystem::hasWId(windows.at(i)))
+        {
+            fetches[windows.at(i)] = AllProperties;
+        }
+    }
+
+    fetchProperties(fetches, properties);
+
+    for (iterator = properties.constBegin(); iterator != properties.constEnd(); ++iterator)
+    {
+        m_pendingFetches.remove(iterator.key());
+
+        m_windows[iterator.key()] = iterator.value();
+    }
 }
 
 }
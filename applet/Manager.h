@@ -21,18 +21,62 @@
 #ifndef FANCYTASKSMANAGER_HEADER
 #define FANCYTASKSMANAGER_HEADER
 
+#include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <QtCore/QTimerEvent>
+#include <QtGui/QWidget>
+
+struct xcb_connection_t;
 
 namespace FancyTasks
 {
 
+struct WindowProperties
+{
+    QString windowClass;
+    QString windowName;
+    QByteArray startupId;
+};
+
 class Manager : public QObject
 {
     Q_OBJECT
 
     public:
+        enum WindowProperty
+        {
+            NoProperties = 0,
+            ClassProperty = 1,
+            StartupIdProperty = 2,
+            AllProperties = 3
+        };
+
         explicit Manager(QObject *parent);
 
+        WindowProperties properties(WId window);
+        void prefetch(const QList<WId> &windows);
+
+    protected:
+        void timerEvent(QTimerEvent *event);
+        void scheduleFetch(WId window, int properties);
+        void fetchProperties(const QHash<WId, int> &fetches, QHash<WId, WindowProperties> &properties);
+        void internAtoms();
+
+    protected slots:
+        void removeWindow(WId window);
+        void changeWindow(WId window, const unsigned long *properties);
+        void flush();
+
+    private:
+        QHash<WId, WindowProperties> m_windows;
+        QHash<WId, int> m_pendingFetches;
+        QVector<uint> m_atoms;
+        xcb_connection_t *m_connection;
+        int m_flushTimer;
+
+    signals:
+        void windowsChanged(QList<WId> windows);
 };
 
 }
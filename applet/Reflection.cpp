@@ -0,0 +1,228 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "Reflection.h"
+
+#include <cstring>
+
+#include <KGlobal>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace FancyTasks
+{
+
+K_GLOBAL_STATIC(Reflection, reflection)
+
+static inline uint byteMultiply(uint pixel, uint alpha)
+{
+    uint low = ((pixel & 0xff00ff) * alpha);
+    low = ((low + ((low >> 8) & 0xff00ff) + 0x800080) >> 8);
+    low &= 0xff00ff;
+
+    uint high = (((pixel >> 8) & 0xff00ff) * alpha);
+    high = (high + ((high >> 8) & 0xff00ff) + 0x800080);
+    high &= 0xff00ff00;
+
+    return (high | low);
+}
+
+static inline uint sourceOver(uint source, uint destination)
+{
+    return (source + byteMultiply(destination, (255 - qAlpha(source))));
+}
+
+#ifdef __SSE2__
+static inline __m128i byteMultiply(__m128i pixels, __m128i alpha)
+{
+    const __m128i componentMask = _mm_set1_epi32(0x00ff00ff);
+    const __m128i half = _mm_set1_epi16(0x80);
+    __m128i low = _mm_mullo_epi16(_mm_and_si128(pixels, componentMask), alpha);
+    __m128i high = _mm_mullo_epi16(_mm_srli_epi16(pixels, 8), alpha);
+
+    low = _mm_add_epi16(low, half);
+    low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+    high = _mm_add_epi16(high, half);
+    high = _mm_andnot_si128(componentMask, _mm_add_epi16(high, _mm_srli_epi16(high, 8)));
+
+    return _mm_or_si128(low, high);
+}
+
+static inline void maskRow(const QRgb *source, QRgb *destination, int count, uint alpha)
+{
+    const __m128i sourceAlpha = _mm_set1_epi16(alpha);
+    const __m128i full = _mm_set1_epi16(255);
+    int i = 0;
+
+    for (; (i + 4) <= count; i += 4)
+    {
+        const __m128i pixels = byteMultiply(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)), sourceAlpha);
+        __m128i inverseAlpha = _mm_srli_epi32(pixels, 24);
+        inverseAlpha = _mm_sub_epi16(full, _mm_or_si128(inverseAlpha, _mm_slli_epi32(inverseAlpha, 16)));
+
+        const __m128i target = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_add_epi32(pixels, byteMultiply(target, inverseAlpha)));
+    }
+
+    for (; i < count; ++i)
+    {
+        destination[i] = sourceOver(byteMultiply(source[i], alpha), destination[i]);
+    }
+}
+#else
+static inline void maskRow(const QRgb *source, QRgb *destination, int count, uint alpha)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        destination[i] = sourceOver(byteMultiply(source[i], alpha), destination[i]);
+    }
+}
+#endif
+
+void Reflection::paint(QImage *image, Plasma::Location location, qreal size)
+{
+    if (!image || image->isNull() || image->format() != QImage::Format_ARGB32_Premultiplied)
+    {
+        return;
+    }
+
+    const bool vertical = (location == Plasma::LeftEdge || location == Plasma::RightEdge);
+    const int extent = (vertical?image->width():image->height());
+    const int breadth = (vertical?image->height():image->width());
+    const int length = (extent * 0.2);
+    int source;
+    int destination;
+
+    switch (location)
+    {
+        case Plasma::LeftEdge:
+            source = (extent * 0.2);
+            destination = 0;
+
+            break;
+        case Plasma::RightEdge:
+            source = (extent * 0.5);
+            destination = (extent * 0.7);
+
+            break;
+        case Plasma::TopEdge:
+            source = (size / 4);
+            destination = 0;
+
+            break;
+        default:
+            source = (extent * 0.5);
+            destination = (extent * 0.7);
+
+            break;
+    }
+
+    if (length < 1 || source < 0 || (source + length) > extent || (destination + length) > extent)
+    {
+        return;
+    }
+
+    const QVector<uchar> &alphaMask = mask(location, length);
+
+    if (vertical)
+    {
+        m_buffer.resize(length);
+
+        QRgb *buffer = m_buffer.data();
+
+        for (int i = 0; i < breadth; ++i)
+        {
+            QRgb *line = reinterpret_cast<QRgb*>(image->scanLine(i));
+
+            memcpy(buffer, (line + source), (length * sizeof(QRgb)));
+
+            for (int j = 0; j < length; ++j)
+            {
+                if (alphaMask.at(j))
+                {
+                    line[destination + j] = sourceOver(byteMultiply(buffer[length - 1 - j], alphaMask.at(j)), line[destination + j]);
+                }
+            }
+        }
+    }
+    else
+    {
+        m_buffer.resize(length * breadth);
+
+        QRgb *buffer = m_buffer.data();
+
+        for (int i = 0; i < length; ++i)
+        {
+            memcpy((buffer + (i * breadth)), image->constScanLine(source + i), (breadth * sizeof(QRgb)));
+        }
+
+        for (int i = 0; i < length; ++i)
+        {
+            if (alphaMask.at(i))
+            {
+                maskRow((buffer + ((length - 1 - i) * breadth)), reinterpret_cast<QRgb*>(image->scanLine(destination + i)), breadth, alphaMask.at(i));
+            }
+        }
+    }
+}
+
+const QVector<uchar>& Reflection::mask(Plasma::Location location, int length)
+{
+    const bool reversed = (location == Plasma::LeftEdge || location == Plasma::TopEdge);
+    const int key = ((length << 1) | (reversed?1:0));
+
+    if (m_masks.contains(key))
+    {
+        return m_masks[key];
+    }
+
+    QVector<uchar> alphaMask(length);
+
+    for (int i = 0; i < length; ++i)
+    {
+        const qreal position = (((reversed?(length - 1 - i):i) + 0.5) / length);
+        qreal alpha = 0;
+
+        if (position < 0.6)
+        {
+            alpha = (200 - (130 * (position / 0.6)));
+        }
+        else if (position < 0.9)
+        {
+            alpha = (70 * ((0.9 - position) / 0.3));
+        }
+
+        alphaMask[i] = qRound(alpha);
+    }
+
+    m_masks[key] = alphaMask;
+
+    return m_masks[key];
+}
+
+Reflection* Reflection::self()
+{
+    return reflection;
+}
+
+}
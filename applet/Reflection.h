@@ -0,0 +1,49 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#ifndef FANCYTASKSREFLECTION_HEADER
+#define FANCYTASKSREFLECTION_HEADER
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+
+#include <Plasma/Plasma>
+
+namespace FancyTasks
+{
+
+class Reflection
+{
+    public:
+        void paint(QImage *image, Plasma::Location location, qreal size);
+        static Reflection* self();
+
+    protected:
+        const QVector<uchar>& mask(Plasma::Location location, int length);
+
+    private:
+        QHash<int, QVector<uchar> > m_masks;
+        QVector<QRgb> m_buffer;
+};
+
+}
+
+#endif
@@ -0,0 +1,271 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "RuleMatcher.h"
+#include "Launcher.h"
+
+#include <QtCore/QQueue>
+
+namespace FancyTasks
+{
+
+RuleMatcher::RuleMatcher() : m_isValid(false)
+{
+}
+
+void RuleMatcher::compile(const QList<QPointer<Launcher> > &launchers)
+{
+    m_launchers.clear();
+    m_launcherRules.clear();
+    m_requiredRules.clear();
+    m_tables.clear();
+
+    for (int i = 0; i < launchers.count(); ++i)
+    {
+        if (!launchers.at(i) || launchers.at(i)->isMenu() || launchers.at(i)->isExcluded() || launchers.at(i)->rules().isEmpty())
+        {
+            continue;
+        }
+
+        const QMap<ConnectionRule, LauncherRule> rules = launchers.at(i)->rules();
+        QMap<ConnectionRule, LauncherRule>::const_iterator iterator;
+
+        for (iterator = rules.constBegin(); iterator != rules.constEnd(); ++iterator)
+        {
+            const int rule = m_requiredRules.count();
+
+            m_requiredRules.append(iterator.value().required);
+
+            if (!m_tables.contains(iterator.key()))
+            {
+                m_tables[iterator.key()] = RuleTable();
+                m_tables[iterator.key()].patternNodes.append(PatternNode());
+                m_tables[iterator.key()].patternNodes[0].failure = 0;
+            }
+
+            RuleTable *table = &m_tables[iterator.key()];
+
+            switch (iterator.value().match)
+            {
+                case ExactMatch:
+                    table->exactRules[iterator.value().expression].append(rule);
+
+                    break;
+                case PartialMatch:
+                    if (iterator.value().expression.isEmpty())
+                    {
+                        table->anyValueRules.append(rule);
+                    }
+                    else
+                    {
+                        addPattern(table, iterator.value().expression, rule);
+                    }
+
+                    break;
+                case RegExpMatch:
+                    table->expressionRules.append(qMakePair(QRegExp(iterator.value().expression, Qt::CaseInsensitive), rule));
+
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        m_launchers.append(launchers.at(i));
+        m_launcherRules.append(m_requiredRules.count());
+    }
+
+    QMap<ConnectionRule, RuleTable>::iterator iterator;
+
+    for (iterator = m_tables.begin(); iterator != m_tables.end(); ++iterator)
+    {
+        buildPatterns(&iterator.value());
+    }
+
+    m_isValid = true;
+}
+
+void RuleMatcher::invalidate()
+{
+    m_isValid = false;
+}
+
+void RuleMatcher::addPattern(RuleTable *table, const QString &pattern, int rule)
+{
+    int node = 0;
+
+    for (int i = 0; i < pattern.length(); ++i)
+    {
+        const ushort character = pattern.at(i).unicode();
+
+        if (!table->patternNodes[node].transitions.contains(character))
+        {
+            table->patternNodes.append(PatternNode());
+            table->patternNodes.last().failure = 0;
+            table->patternNodes[node].transitions[character] = (table->patternNodes.count() - 1);
+        }
+
+        node = table->patternNodes[node].transitions[character];
+    }
+
+    table->patternNodes[node].rules.append(rule);
+}
+
+void RuleMatcher::buildPatterns(RuleTable *table)
+{
+    QQueue<int> nodes;
+    QHash<ushort, int>::const_iterator iterator;
+
+    for (iterator = table->patternNodes[0].transitions.constBegin(); iterator != table->patternNodes[0].transitions.constEnd(); ++iterator)
+    {
+        table->patternNodes[iterator.value()].failure = 0;
+
+        nodes.enqueue(iterator.value());
+    }
+
+    while (!nodes.isEmpty())
+    {
+        const int node = nodes.dequeue();
+
+        for (iterator = table->patternNodes[node].transitions.constBegin(); iterator != table->patternNodes[node].transitions.constEnd(); ++iterator)
+        {
+            int failure = table->patternNodes[node].failure;
+
+            while (failure > 0 && !table->patternNodes[failure].transitions.contains(iterator.key()))
+            {
+                failure = table->patternNodes[failure].failure;
+            }
+
+            failure = table->patternNodes[failure].transitions.value(iterator.key(), 0);
+
+            if (failure == iterator.value())
+            {
+                failure = 0;
+            }
+
+            table->patternNodes[iterator.value()].failure = failure;
+            table->patternNodes[iterator.value()].rules.append(table->patternNodes[failure].rules);
+
+            nodes.enqueue(iterator.value());
+        }
+    }
+}
+
+void RuleMatcher::matchPatterns(const RuleTable &table, const QString &value, QVector<bool> *matched) const
+{
+    if (table.patternNodes.count() < 2)
+    {
+        return;
+    }
+
+    int node = 0;
+
+    for (int i = 0; i < value.length(); ++i)
+    {
+        const ushort character = value.at(i).unicode();
+
+        while (node > 0 && !table.patternNodes.at(node).transitions.contains(character))
+        {
+            node = table.patternNodes.at(node).failure;
+        }
+
+        node = table.patternNodes.at(node).transitions.value(character, 0);
+
+        const QList<int> &rules = table.patternNodes.at(node).rules;
+
+        for (int j = 0; j < rules.count(); ++j)
+        {
+            (*matched)[rules.at(j)] = true;
+        }
+    }
+}
+
+Launcher* RuleMatcher::match(const QMap<ConnectionRule, QString> &values)
+{
+    QVector<bool> matched(m_requiredRules.count(), false);
+    QMap<ConnectionRule, RuleTable>::iterator iterator;
+
+    for (iterator = m_tables.begin(); iterator != m_tables.end(); ++iterator)
+    {
+        const QString value = values.value(iterator.key());
+
+        if (value.isEmpty())
+        {
+            continue;
+        }
+
+        RuleTable &table = iterator.value();
+        const QList<int> exactRules = table.exactRules.value(value);
+
+        for (int i = 0; i < exactRules.count(); ++i)
+        {
+            matched[exactRules.at(i)] = true;
+        }
+
+        for (int i = 0; i < table.anyValueRules.count(); ++i)
+        {
+            matched[table.anyValueRules.at(i)] = true;
+        }
+
+        for (int i = 0; i < table.expressionRules.count(); ++i)
+        {
+            if (table.expressionRules[i].first.exactMatch(value))
+            {
+                matched[table.expressionRules.at(i).second] = true;
+            }
+        }
+
+        matchPatterns(table, value, &matched);
+    }
+
+    int rule = 0;
+
+    for (int i = 0; i < m_launchers.count(); ++i)
+    {
+        int amount = 0;
+        bool rejected = false;
+
+        for (; rule < m_launcherRules.at(i); ++rule)
+        {
+            if (matched.at(rule))
+            {
+                ++amount;
+            }
+            else if (m_requiredRules.at(rule))
+            {
+                rejected = true;
+            }
+        }
+
+        if (amount > 0 && !rejected && m_launchers.at(i))
+        {
+            return m_launchers.at(i);
+        }
+    }
+
+    return NULL;
+}
+
+bool RuleMatcher::isValid() const
+{
+    return m_isValid;
+}
+
+}
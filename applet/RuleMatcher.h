@@ -0,0 +1,76 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#ifndef FANCYTASKSRULEMATCHER_HEADER
+#define FANCYTASKSRULEMATCHER_HEADER
+
+#include "Constants.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QtCore/QRegExp>
+#include <QtCore/QPointer>
+
+namespace FancyTasks
+{
+
+class Launcher;
+
+class RuleMatcher
+{
+    public:
+        RuleMatcher();
+
+        void compile(const QList<QPointer<Launcher> > &launchers);
+        void invalidate();
+        Launcher* match(const QMap<ConnectionRule, QString> &values);
+        bool isValid() const;
+
+    protected:
+        struct PatternNode
+        {
+            QHash<ushort, int> transitions;
+            QList<int> rules;
+            int failure;
+        };
+
+        struct RuleTable
+        {
+            QHash<QString, QList<int> > exactRules;
+            QList<QPair<QRegExp, int> > expressionRules;
+            QList<int> anyValueRules;
+            QVector<PatternNode> patternNodes;
+        };
+
+        void addPattern(RuleTable *table, const QString &pattern, int rule);
+        void buildPatterns(RuleTable *table);
+        void matchPatterns(const RuleTable &table, const QString &value, QVector<bool> *matched) const;
+
+    private:
+        QList<QPointer<Launcher> > m_launchers;
+        QVector<int> m_launcherRules;
+        QVector<bool> m_requiredRules;
+        QMap<ConnectionRule, RuleTable> m_tables;
+        bool m_isValid;
+};
+
+}
+
+#endif
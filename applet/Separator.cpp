@@ -21,6 +21,8 @@
 #include "Separator.h"
 #include "Applet.h"
 
+#include <QtGui/QPainter>
+
 namespace FancyTasks
 {
 
@@ -40,6 +42,14 @@ Separator::Separator(Plasma::Svg *svg, Applet *applet) : Plasma::SvgWidget(svg,
     connect(m_applet, SIGNAL(locationChanged()), this, SLOT(updateOrientation()));
 }
 
+void Separator::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option)
+    Q_UNUSED(widget)
+
+    painter->drawPixmap(boundingRect().topLeft(), m_applet->themePixmap(elementID(), boundingRect().size().toSize()));
+}
+
 void Separator::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
 {
     emit hoverMoved(this, (qreal) (((m_applet->location() == Plasma::LeftEdge || m_applet->location() == Plasma::RightEdge)?event->pos().y():event->pos().x()) / m_size));
@@ -42,6 +42,7 @@ class Separator : public Plasma::SvgWidget
         bool isVisible() const;
 
     protected:
+        void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
         void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
         void hoverLeaveEvent(QGraphicsSceneHoverEvent *event);
 
@@ -0,0 +1,101 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "ServiceIndex.h"
+
+#include <KShell>
+#include <KGlobal>
+#include <KSycoca>
+#include <KService>
+
+namespace FancyTasks
+{
+
+K_GLOBAL_STATIC(ServiceIndex, serviceIndex)
+
+ServiceIndex::ServiceIndex() : QObject(),
+    m_isValid(false)
+{
+    connect(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), this, SLOT(invalidate()));
+}
+
+void ServiceIndex::rebuild()
+{
+    m_entryPaths.clear();
+
+    const KService::List services = KService::allServices();
+
+    for (int i = 0; i < services.count(); ++i)
+    {
+        if (!services.at(i)->isApplication() || services.at(i)->exec().isEmpty())
+        {
+            continue;
+        }
+
+        const QStringList arguments = KShell::splitArgs(services.at(i)->exec());
+        int index = 0;
+
+        if (arguments.value(0).section('/', -1, -1, QString::SectionSkipEmpty) == "env")
+        {
+            index = 1;
+
+            while (index < arguments.count() && (arguments.at(index).startsWith('-') || arguments.at(index).contains('=')))
+            {
+                ++index;
+            }
+        }
+
+        const QString executable = arguments.value(index).section('/', -1, -1, QString::SectionSkipEmpty).toLower();
+
+        if (!executable.isEmpty() && !m_entryPaths.contains(executable))
+        {
+            m_entryPaths[executable] = services.at(i)->entryPath();
+        }
+    }
+
+    m_isValid = true;
+}
+
+void ServiceIndex::invalidate()
+{
+    m_isValid = false;
+}
+
+QString ServiceIndex::entryPath(const QString &command)
+{
+    if (!m_isValid)
+    {
+        rebuild();
+    }
+
+    return m_entryPaths.value(executableName(command).toLower());
+}
+
+QString ServiceIndex::executableName(const QString &command)
+{
+    return command.section(' ', 0, 0, QString::SectionSkipEmpty).section('/', -1, -1, QString::SectionSkipEmpty);
+}
+
+ServiceIndex* ServiceIndex::self()
+{
+    return serviceIndex;
+}
+
+}
@@ -0,0 +1,132 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#include "StartupMatcher.h"
+#include "ServiceIndex.h"
+#include "Icon.h"
+
+namespace FancyTasks
+{
+
+void StartupMatcher::addStartup(Icon *icon, const QByteArray &identifier, const QString &binary)
+{
+    if (!icon)
+    {
+        return;
+    }
+
+    removeStartup(icon);
+
+    const QString key = binaryKey(binary);
+
+    if (!identifier.isEmpty())
+    {
+        m_identifiers[identifier] = icon;
+    }
+
+    if (!key.isEmpty())
+    {
+        m_binaries.insert(key, icon);
+    }
+
+    m_keys[icon] = qMakePair(identifier, key);
+}
+
+void StartupMatcher::removeStartup(QObject *icon)
+{
+    if (!m_keys.contains(icon))
+    {
+        return;
+    }
+
+    const QPair<QByteArray, QString> keys = m_keys.take(icon);
+
+    if (!keys.first.isEmpty() && (!m_identifiers.value(keys.first) || m_identifiers.value(keys.first).data() == icon))
+    {
+        m_identifiers.remove(keys.first);
+    }
+
+    if (!keys.second.isEmpty())
+    {
+        QMultiHash<QString, QPointer<Icon> >::iterator iterator = m_binaries.find(keys.second);
+
+        while (iterator != m_binaries.end() && iterator.key() == keys.second)
+        {
+            if (!iterator.value() || iterator.value().data() == icon)
+            {
+                iterator = m_binaries.erase(iterator);
+            }
+            else
+            {
+                ++iterator;
+            }
+        }
+    }
+}
+
+void StartupMatcher::clear()
+{
+    m_identifiers.clear();
+    m_binaries.clear();
+    m_keys.clear();
+}
+
+Icon* StartupMatcher::match(const QByteArray &identifier, const QStringList &names) const
+{
+    if (!identifier.isEmpty())
+    {
+        Icon *icon = m_identifiers.value(identifier);
+
+        if (icon && icon->itemType() == StartupType)
+        {
+            return icon;
+        }
+    }
+
+    for (int i = 0; i < names.count(); ++i)
+    {
+        const QString key = binaryKey(names.at(i));
+        QMultiHash<QString, QPointer<Icon> >::const_iterator iterator = m_binaries.constFind(key);
+
+        while (iterator != m_binaries.constEnd() && iterator.key() == key)
+        {
+            if (iterator.value() && iterator.value()->itemType() == StartupType)
+            {
+                return iterator.value();
+            }
+
+            ++iterator;
+        }
+    }
+
+    return NULL;
+}
+
+int StartupMatcher::count() const
+{
+    return m_keys.count();
+}
+
+QString StartupMatcher::binaryKey(const QString &name)
+{
+    return ServiceIndex::executableName(name).toLower();
+}
+
+}
@@ -0,0 +1,55 @@
+/***********************************************************************************
+* Fancy Tasks: Plasmoid providing fancy visualization of tasks, launchers and jobs.
+* Copyright (C) 2009-2013 Michal Dutkiewicz aka Emdek <emdeck@gmail.com>
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*
+***********************************************************************************/
+
+#ifndef FANCYTASKSSTARTUPMATCHER_HEADER
+#define FANCYTASKSSTARTUPMATCHER_HEADER
+
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QPointer>
+#include <QtCore/QByteArray>
+#include <QtCore/QStringList>
+
+namespace FancyTasks
+{
+
+class Icon;
+
+class StartupMatcher
+{
+    public:
+        void addStartup(Icon *icon, const QByteArray &identifier, const QString &binary);
+        void removeStartup(QObject *icon);
+        void clear();
+        Icon* match(const QByteArray &identifier, const QStringList &names) const;
+        int count() const;
+
+    protected:
+        static QString binaryKey(const QString &name);
+
+    private:
+        QHash<QByteArray, QPointer<Icon> > m_identifiers;
+        QMultiHash<QString, QPointer<Icon> > m_binaries;
+        QHash<QObject*, QPair<QByteArray, QString> > m_keys;
+};
+
+}
+
+#endif
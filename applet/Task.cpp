@@ -21,15 +21,15 @@
 #include "Task.h"
 #include "Applet.h"
 #include "FindApplicationDialog.h"
+#include "CommandResolver.h"
+#include "ServiceIndex.h"
+
+#include <signal.h>
 
 #include <KLocale>
 #include <KMessageBox>
 #include <NETRootInfo>
 #include <KWindowSystem>
-#include <KServiceTypeTrader>
-
-#include <ksysguard/process.h>
-#include <ksysguard/processes.h>
 
 namespace FancyTasks
 {
@@ -117,12 +117,9 @@ void Task::close()
 
 void Task::kill()
 {
-    KSysGuard::Processes processes;
-    processes.updateAllProcesses();
-
-    if (m_taskType == TaskType && m_task)
+    if (m_taskType == TaskType && m_task && m_task->task() && m_task->task()->pid() > 0)
     {
-        processes.killProcess(m_task->task()->pid());
+        ::kill(m_task->task()->pid(), SIGTERM);
     }
     else if (m_taskType == GroupType && m_group)
     {
@@ -132,9 +129,9 @@ void Task::kill()
         {
             TaskItem *task = qobject_cast<TaskItem*>(members.at(i));
 
-            if (task)
+            if (task && task->task() && task->task()->pid() > 0)
             {
-                processes.killProcess(task->task()->pid());
+                ::kill(task->task()->pid(), SIGTERM);
             }
         }
     }
@@ -490,11 +487,11 @@ void Task::setTask(AbstractGroupableItem *abstractItem)
 
     if (!m_command.isEmpty())
     {
-        KService::List services = KServiceTypeTrader::self()->query("Application", QString("exist Exec and ('%1' ~~ Exec)").arg(m_command.simplified().split(QRegExp("(?!\\\\)\\s"), QString::SkipEmptyParts).first().split(QRegExp("(?!\\\\)\\/"), QString::SkipEmptyParts).last()));
+        const QString entryPath = ServiceIndex::self()->entryPath(m_command);
 
-        if (!services.isEmpty())
+        if (!entryPath.isEmpty())
         {
-            m_launcherUrl = services.first()->entryPath();
+            m_launcherUrl = entryPath;
         }
     }
 
@@ -628,17 +625,7 @@ QString Task::command() const
 
 QString Task::command(int pid) const
 {
-    KSysGuard::Processes processes;
-    processes.updateAllProcesses();
-
-    KSysGuard::Process *process = processes.getProcess(pid);
-
-    if (process)
-    {
-        return process->command;
-    }
-
-    return QString();
+    return CommandResolver::self()->command(pid);
 }
 
 QList<WId> Task::windows() const